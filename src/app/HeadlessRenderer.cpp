@@ -0,0 +1,144 @@
+/*
+ * HeadlessRenderer.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HeadlessRenderer.h"
+
+#include <iostream>
+#include <algorithm>
+
+#include <QDir>
+#include <QElapsedTimer>
+
+#include "Compositor.h"
+#include "ProjectReader.h"
+
+namespace mmp {
+
+HeadlessRenderer::HeadlessRenderer(MainWindow* window, const QSize& size)
+  : _window(window),
+    _size(size)
+{
+  Q_CHECK_PTR(window);
+}
+
+bool HeadlessRenderer::loadProject(const QString& fileName)
+{
+  QFile file(fileName);
+  if (! file.open(QFile::ReadOnly | QFile::Text))
+  {
+    std::cerr << "Cannot read file " << qPrintable(fileName) << ": "
+              << qPrintable(file.errorString()) << std::endl;
+    return false;
+  }
+
+  // Read project directly (MainWindow::loadFile() would pop up message boxes on errors).
+  ProjectReader reader(_window);
+  if (! reader.readFile(&file))
+  {
+    std::cerr << "Parse error in file " << qPrintable(fileName) << ": "
+              << qPrintable(reader.errorString()) << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool HeadlessRenderer::render(int nFrames, const QString& outputDirectory)
+{
+  if (!outputDirectory.isEmpty() && !QDir().mkpath(outputDirectory))
+  {
+    std::cerr << "Cannot create directory " << qPrintable(outputDirectory) << std::endl;
+    return false;
+  }
+
+  // Render using the context of the (hidden) destination canvas, which makes sure
+  // the GL widget has a native surface to make its context current.
+  QWidget* viewport = _window->getDestinationCanvas()->viewport();
+  viewport->winId();
+
+  Compositor compositor((const QGLWidget*)viewport);
+  QGraphicsScene* scene = _window->getDestinationCanvas()->scene();
+  QRectF sceneRect(QPointF(0, 0), _size);
+
+  _frameTimes.clear();
+  _frameTimes.reserve(nFrames);
+
+  // The window would otherwise keep rendering its own frames while we pump events.
+  FrameClock* frameClock = _window->getFrameClock();
+  bool frameClockWasActive = frameClock->isActive();
+  frameClock->stop();
+
+  QElapsedTimer timer;
+  for (int i=0; i<nFrames; i++)
+  {
+    // Let paints receive new frames.
+    QCoreApplication::processEvents();
+
+    timer.start();
+    compositor.render(scene, sceneRect, _size);
+    glFinish();
+    qreal frameTime = timer.nsecsElapsed() / 1000000.0;
+    _frameTimes.append(frameTime);
+
+    std::cout << "frame " << i << ": " << frameTime << " ms" << std::endl;
+
+    if (!outputDirectory.isEmpty())
+    {
+      QString fileName = QDir(outputDirectory).filePath(QString("frame-%1.png").arg(i, 6, 10, QChar('0')));
+      if (!compositor.toImage().save(fileName))
+      {
+        std::cerr << "Cannot write frame " << qPrintable(fileName) << std::endl;
+        if (frameClockWasActive)
+          frameClock->start();
+        return false;
+      }
+    }
+  }
+
+  if (frameClockWasActive)
+    frameClock->start();
+
+  _printStatistics();
+  return true;
+}
+
+void HeadlessRenderer::_printStatistics() const
+{
+  if (_frameTimes.isEmpty())
+    return;
+
+  QVector<qreal> sorted = _frameTimes;
+  std::sort(sorted.begin(), sorted.end());
+
+  qreal total = 0;
+  for (int i=0; i<sorted.size(); i++)
+    total += sorted[i];
+  qreal average = total / sorted.size();
+
+  std::cout << "frames: "  << sorted.size()
+            << " size: "   << _size.width() << "x" << _size.height()
+            << " min: "    << sorted.first() << " ms"
+            << " median: " << sorted[sorted.size() / 2] << " ms"
+            << " 99%: "    << sorted[qMin(int(sorted.size() * 0.99), sorted.size() - 1)] << " ms"
+            << " max: "    << sorted.last() << " ms"
+            << " average: " << average << " ms"
+            << " (" << (average > 0 ? 1000.0 / average : 0) << " fps)" << std::endl;
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+ * HeadlessRenderer.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSRENDERER_H_
+#define HEADLESSRENDERER_H_
+
+#include <QString>
+#include <QSize>
+#include <QVector>
+
+#include "MainWindow.h"
+
+namespace mmp {
+
+/**
+ * Renders a project offscreen without displaying any window (see --headless option).
+ * Each frame is rendered through a Compositor into a framebuffer; per-frame timings
+ * are reported on standard output and frames can optionally be saved to disk.
+ *
+ * The GL implementation is whatever the Qt platform provides: use eg. the "offscreen"
+ * platform (default in headless mode) together with LIBGL_ALWAYS_SOFTWARE=1 to render
+ * with llvmpipe on machines without a GPU.
+ */
+class HeadlessRenderer
+{
+public:
+  HeadlessRenderer(MainWindow* window, const QSize& size);
+
+  /// Loads project file. Returns false (and prints error) on failure.
+  bool loadProject(const QString& fileName);
+
+  /**
+   * Renders nFrames frames. If outputDirectory is not empty, frames are written there
+   * as numbered PNG files. Returns false on error.
+   */
+  bool render(int nFrames, const QString& outputDirectory = QString());
+
+private:
+  void _printStatistics() const;
+
+  MainWindow* _window;
+  QSize _size;
+
+  // Frame times (in ms).
+  QVector<qreal> _frameTimes;
+};
+
+}
+
+#endif /* HEADLESSRENDERER_H_ */
@@ -1,9 +1,11 @@
 
 include(../src.pri)
 
-HEADERS += $$PWD/MainApplication.h
+HEADERS += $$PWD/HeadlessRenderer.h \
+    $$PWD/MainApplication.h
 
-SOURCES += $$PWD/MainApplication.cpp \
+SOURCES += $$PWD/HeadlessRenderer.cpp \
+    $$PWD/MainApplication.cpp \
     $$PWD/main.cpp
 
 MOC_DIR = $$PWD/mocs
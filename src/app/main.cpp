@@ -12,6 +12,7 @@
 #include "MM.h"
 #include "MainWindow.h"
 #include "MainApplication.h"
+#include "HeadlessRenderer.h"
 
 #include "MetaObjectRegistry.h"
 
@@ -75,8 +76,25 @@ void logMessageHandler(QtMsgType type, const QMessageLogContext &context, const
 
 int main(int argc, char *argv[])
 {
-  // Install message handler
-  qInstallMessageHandler(logMessageHandler);
+  // Headless mode needs to be known before the application is created.
+  bool headless = false;
+  for (int i=1; i<argc; i++)
+  {
+    if (QString(argv[i]) == "--headless")
+      headless = true;
+  }
+
+  if (headless)
+  {
+    // Render offscreen unless another platform was explicitly requested.
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  else
+  {
+    // Install message handler
+    qInstallMessageHandler(logMessageHandler);
+  }
 
   set_env_vars_if_needed();
 
@@ -125,6 +143,26 @@ int main(int argc, char *argv[])
     "Use a framerate of <frame-rate> per second.", "frame-rate", QString::number(MM::DEFAULT_FRAMES_PER_SECOND));
   parser.addOption(frameRateOption);
 
+  // --headless option
+  QCommandLineOption headlessOption(QStringList() << "headless",
+    "Render project offscreen without any window, print frame timings and exit.");
+  parser.addOption(headlessOption);
+
+  // --frames option
+  QCommandLineOption framesOption(QStringList() << "frames",
+    "In headless mode, render <frames> frames.", "frames", "300");
+  parser.addOption(framesOption);
+
+  // --size option
+  QCommandLineOption sizeOption(QStringList() << "size",
+    "In headless mode, render frames of size <size> (eg. 1920x1080).", "size", "1920x1080");
+  parser.addOption(sizeOption);
+
+  // --output-dir option
+  QCommandLineOption outputDirOption(QStringList() << "output-dir",
+    "In headless mode, write frames as PNG files in <output-dir>.", "output-dir", "");
+  parser.addOption(outputDirOption);
+
   // Positional argument: file
   parser.addPositionalArgument("file", "Load project from that file.");
 
@@ -175,6 +213,41 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+#if USING_QT_5
+  if (parser.isSet(headlessOption))
+  {
+    QString projectFile = parser.positionalArguments().isEmpty()
+                          ? parser.value("file")
+                          : parser.positionalArguments().first();
+    if (projectFile.isEmpty())
+    {
+      std::cerr << "A project file is required in headless mode." << std::endl;
+      return 1;
+    }
+
+    bool framesOk;
+    int nFrames = parser.value("frames").toInt(&framesOk);
+    QStringList sizeValues = parser.value("size").split('x');
+    bool widthOk = false, heightOk = false;
+    QSize size;
+    if (sizeValues.size() == 2)
+      size = QSize(sizeValues[0].toInt(&widthOk), sizeValues[1].toInt(&heightOk));
+    if (!framesOk || nFrames < 0 || !widthOk || !heightOk || size.isEmpty())
+    {
+      std::cerr << "Invalid option <frames> or <size>." << std::endl;
+      return 1;
+    }
+
+    // The main window is created but never shown.
+    MainWindow* win = MainWindow::window();
+    HeadlessRenderer renderer(win, size);
+    bool success = renderer.loadProject(projectFile) &&
+                   renderer.render(nFrames, parser.value("output-dir"));
+    delete win;
+    return (success ? 0 : 1);
+  }
+#endif
+
   // Create splash screen.
   QPixmap pixmap(":/mapmap-splash");
   QSplashScreen splash(pixmap);
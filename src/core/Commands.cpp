@@ -81,6 +81,30 @@ void AddMappingCommand::redo()
   }
 }
 
+AddMappingsCommand::AddMappingsCommand(MainWindow *mainWindow, const QVector<uid>& mappingIds, QUndoCommand *parent):
+  QUndoCommand(parent),
+  _mainWindow(mainWindow),
+  _mappingIds(mappingIds)
+{
+  setText(QObject::tr("Add %n layer(s)", 0, mappingIds.size()));
+}
+
+void AddMappingsCommand::undo()
+{
+  MappingManager& mappingManager = _mainWindow->getMappingManager();
+  _mappings.clear();
+  foreach (uid mappingId, _mappingIds)
+    _mappings.push_back(mappingManager.getMappingById(mappingId));
+  _mainWindow->deleteMappings(_mappingIds);
+}
+
+void AddMappingsCommand::redo()
+{
+  if (!_mappings.isEmpty())
+    _mainWindow->getMappingManager().addMappings(_mappings);
+  _mainWindow->addMappingItems(_mappingIds);
+}
+
 DuplicateMappingCommand::DuplicateMappingCommand(MainWindow *mainWindow, uid cloneId, QUndoCommand *parent):
   AddMappingCommand(mainWindow, cloneId, parent)
 {
@@ -252,6 +276,65 @@ void TranslateShapeCommand::_doTransform(MShape::ptr shape)
   shape->translate(_translation);
 }
 
+MoveWarpPointCommand::MoveWarpPointCommand(OutputCorrection::ptr correction, TransformShapeCommand::TransformShapeOption option, int column, int row, const QPointF &point, QUndoCommand *parent)
+  : QUndoCommand(parent),
+    _correction(correction),
+    _option(option),
+    _column(column),
+    _row(row),
+    _originalPoint(correction->getWarpPoint(column, row)),
+    _point(point)
+{
+  setText(QObject::tr("Move warp point"));
+}
+
+void MoveWarpPointCommand::undo()
+{
+  // The output or its warp grid may have changed since.
+  OutputCorrection::ptr correction = _correction.toStrongRef();
+  if (correction.isNull() ||
+      _column > correction->getWarpColumns() || _row > correction->getWarpRows())
+    return;
+
+  correction->setWarpPoint(_column, _row, _originalPoint);
+  MainWindow::window()->windowModified();
+}
+
+void MoveWarpPointCommand::redo()
+{
+  // The output or its warp grid may have changed since.
+  OutputCorrection::ptr correction = _correction.toStrongRef();
+  if (correction.isNull() ||
+      _column > correction->getWarpColumns() || _row > correction->getWarpRows())
+    return;
+
+  correction->setWarpPoint(_column, _row, _point);
+  MainWindow::window()->windowModified();
+}
+
+int MoveWarpPointCommand::id() const { return CMD_MOUSE_MOVE_WARP_POINT; }
+
+bool MoveWarpPointCommand::mergeWith(const QUndoCommand* other)
+{
+  if (other->id() != id())
+    return false;
+
+  const MoveWarpPointCommand* cmd = static_cast<const MoveWarpPointCommand*>(other);
+
+  // Each drag'n'drop is a separate command.
+  if (_option == TransformShapeCommand::RELEASE && cmd->_option == TransformShapeCommand::FREE)
+    return false;
+
+  // Needs to be the same point of the same output.
+  if (cmd->_correction != _correction ||
+      cmd->_column != _column || cmd->_row != _row)
+    return false;
+
+  _point = cmd->_point;
+  _option = cmd->_option;
+  return true;
+}
+
 RemovePaintCommand::RemovePaintCommand(MainWindow *mainWindow, uid paintId, QUndoCommand *parent):
   QUndoCommand(parent),
   _mainWindow(mainWindow),
@@ -270,13 +353,7 @@ void RemovePaintCommand::undo()
     _mainWindow->addPaintItem(lastId, _paint->getIcon(), _paint->getName());
 
     // Add all mappings associated with paint.
-    QMap<uid, Mapping::ptr> paintMappings = mappingManager.getPaintMappings(_paint);
-    for (QMap<uid, Mapping::ptr>::const_iterator it = _paintMappings.constBegin();
-         it != _paintMappings.constEnd(); ++it) {
-      uid mid = mappingManager.addMapping( it.value() );
-      Q_ASSERT( mid == it.key() );
-      _mainWindow->addMappingItem(mid);
-    }
+    _mainWindow->addMappingItems(mappingManager.addMappings(_paintMappings.values().toVector()));
   }
 }
 
@@ -315,4 +392,51 @@ void DeleteMappingCommand::redo()
   _mainWindow->deleteMapping(_mappingId);
 }
 
+DeleteMappingsCommand::DeleteMappingsCommand(MainWindow *mainWindow, const QVector<uid>& mappingIds, QUndoCommand *parent) :
+  QUndoCommand(parent),
+  _mainWindow(mainWindow),
+  _mappingIds(mappingIds)
+{
+  setText(QObject::tr("Delete %n layer(s)", 0, mappingIds.size()));
+}
+
+void DeleteMappingsCommand::undo()
+{
+  if (_mappings.isEmpty())
+    return;
+
+  MappingManager& mappingManager = _mainWindow->getMappingManager();
+  QVector<uid> mappingIds = mappingManager.addMappings(_mappings);
+
+  // Put layers back at their depth (re-added ones are on top).
+  QVector<uid> order;
+  int nOthers = mappingManager.nMappings() - _mappings.size();
+  for (int i=0; i<nOthers; i++)
+    order.push_back(mappingManager.getMapping(i)->getId());
+  for (int i=0; i<_mappings.size(); i++)
+    order.insert(qMin(_mappingDepths[i], order.size()), mappingIds[i]);
+  mappingManager.reorderMappings(order);
+
+  _mainWindow->addMappingItems(mappingIds);
+}
+
+void DeleteMappingsCommand::redo()
+{
+  // Store mapping pointers (in layer order) before deleting them.
+  MappingManager& mappingManager = _mainWindow->getMappingManager();
+  QSet<uid> mappingIds = _mappingIds.toList().toSet();
+  _mappings.clear();
+  _mappingDepths.clear();
+  for (int i=0; i<mappingManager.nMappings(); i++)
+  {
+    Mapping::ptr mapping = mappingManager.getMapping(i);
+    if (mappingIds.contains(mapping->getId()))
+    {
+      _mappings.push_back(mapping);
+      _mappingDepths.push_back(i);
+    }
+  }
+  _mainWindow->deleteMappings(_mappingIds);
+}
+
 }
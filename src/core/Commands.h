@@ -24,6 +24,7 @@
 
 #include <QUndoCommand>
 #include "MM.h"
+#include "OutputCorrection.h"
 
 namespace mmp {
 
@@ -34,6 +35,7 @@ enum CommandId {
   CMD_MOUSE_TRANSLATE_SHAPE,
   CMD_KEY_SCALE_ROTATE_SHAPE,
   CMD_MOUSE_SCALE_ROTATE_SHAPE,
+  CMD_MOUSE_MOVE_WARP_POINT,
 };
 
 class MainWindow;
@@ -69,6 +71,20 @@ private:
   uid _mappingId;
 };
 
+class AddMappingsCommand : public QUndoCommand
+{
+public:
+  explicit AddMappingsCommand(MainWindow *mainWindow, const QVector<uid>& mappingIds, QUndoCommand *parent = 0);
+
+  void undo() Q_DECL_OVERRIDE;
+  void redo() Q_DECL_OVERRIDE;
+
+private:
+  MainWindow *_mainWindow;
+  QVector<Mapping::ptr> _mappings;
+  QVector<uid> _mappingIds;
+};
+
 class DuplicateMappingCommand : public AddMappingCommand
 {
 public:
@@ -156,6 +172,25 @@ private:
   QPointF _translation;
 };
 
+class MoveWarpPointCommand : public QUndoCommand
+{
+public:
+  MoveWarpPointCommand(OutputCorrection::ptr correction, TransformShapeCommand::TransformShapeOption option, int column, int row, const QPointF &point, QUndoCommand *parent = 0);
+
+  void undo() Q_DECL_OVERRIDE;
+  void redo() Q_DECL_OVERRIDE;
+  int id() const Q_DECL_OVERRIDE;
+  bool mergeWith(const QUndoCommand* other) Q_DECL_OVERRIDE;
+
+private:
+  QWeakPointer<OutputCorrection> _correction;
+  int _option;
+  int _column;
+  int _row;
+  QPointF _originalPoint;
+  QPointF _point;
+};
+
 class RemovePaintCommand : public QUndoCommand
 {
 public:
@@ -185,6 +220,21 @@ private:
   uid _mappingId;
 };
 
+class DeleteMappingsCommand : public QUndoCommand
+{
+public:
+  explicit DeleteMappingsCommand(MainWindow *mainWindow, const QVector<uid>& mappingIds, QUndoCommand *parent = 0);
+
+  void undo() Q_DECL_OVERRIDE;
+  void redo() Q_DECL_OVERRIDE;
+
+private:
+  MainWindow *_mainWindow;
+  QVector<Mapping::ptr> _mappings; // saved in layer order
+  QVector<int> _mappingDepths;      // layer index of each saved mapping
+  QVector<uid> _mappingIds;
+};
+
 }
 
 #endif /* COMMANDS_H_ */
@@ -23,6 +23,10 @@
 
 namespace mmp {
 
+quint64 Element::_nameVersion = 0;
+QList<Element::PropertyChanges> Element::_propertyChanges;
+QHash<Element::ElementKey, int> Element::_propertyChangesIndex;
+
 Element::Element(uid id, UidAllocator* allocator) : _name(""), _isLocked(false), _opacity(1.0f), _allocator(allocator)
 {
   if (id == NULL_UID)
@@ -45,6 +49,7 @@ void Element::setName(const QString& name)
   if (name != _name)
   {
     _name = name;
+    _nameVersion++;
     _emitPropertyChanged("name");
   }
 }
@@ -83,9 +88,37 @@ void Element::write(QDomElement& obj)
   obj.setAttribute("id", getId());
 }
 
+QList<Element::PropertyChanges> Element::takePropertyChanges()
+{
+  QList<PropertyChanges> changes;
+  changes.swap(_propertyChanges);
+  _propertyChangesIndex.clear();
+  return changes;
+}
+
 void Element::_emitPropertyChanged(const QString& propertyName)
 {
-  emit propertyChanged(getId(), propertyName, property(propertyName.toAscii()));
+  int index = metaObject()->indexOfProperty(propertyName.toAscii());
+  Q_ASSERT(index >= 0);
+
+  // Record change (only once until changes are taken).
+  ElementKey key(_allocator, _id);
+  QHash<ElementKey, int>::const_iterator it = _propertyChangesIndex.constFind(key);
+  if (it == _propertyChangesIndex.constEnd())
+  {
+    PropertyChanges changes;
+    changes.allocator = _allocator;
+    changes.id = _id;
+    changes.properties.append(index);
+    _propertyChangesIndex.insert(key, _propertyChanges.size());
+    _propertyChanges.append(changes);
+  }
+  else
+  {
+    QList<int>& properties = _propertyChanges[it.value()].properties;
+    if (!properties.contains(index))
+      properties.append(index);
+  }
 }
 
 }
@@ -23,6 +23,9 @@
 #include <QtGlobal>
 #include <QObject>
 #include <QIcon>
+#include <QHash>
+#include <QList>
+#include <QPair>
 
 #include "Serializable.h"
 #include "UidAllocator.h"
@@ -39,12 +42,24 @@ class Element : public Serializable
   Q_PROPERTY(uid     id      READ getId)
   Q_PROPERTY(QString name    READ getName    WRITE setName)
   Q_PROPERTY(bool    locked  READ isLocked   WRITE setLocked)
-  Q_PROPERTY(float   opacity READ getOpacity WRITE setOpacity NOTIFY propertyChanged)
+  Q_PROPERTY(float   opacity READ getOpacity WRITE setOpacity)
   Q_PROPERTY(QIcon   icon    READ getIcon)
 
 public:
   typedef QSharedPointer<Element> ptr;
 
+  /**
+   * Properties of an element that changed (as indices in its metaObject()). The element is
+   * identified by its id and the allocator of its id, which tells its kind (eg. ids of
+   * mappings come from Mapping::getUidAllocator()).
+   */
+  struct PropertyChanges
+  {
+    const UidAllocator* allocator;
+    uid id;
+    QList<int> properties;
+  };
+
   Element(uid id, UidAllocator* allocator);
   virtual ~Element();
 
@@ -53,6 +68,9 @@ public:
   virtual void setName(const QString& name);
   virtual QString getName() const { return _name; }
 
+  /// Returns a number that changes every time any element is renamed (allows name indices to stay up to date).
+  static quint64 getNameVersion() { return _nameVersion; }
+
   virtual float getOpacity() const { return _opacity; }
   virtual void setOpacity(float opacity);
 
@@ -67,21 +85,38 @@ public:
   virtual void read(const QDomElement& obj);
   virtual void write(QDomElement& obj);
 
-signals:
-  void propertyChanged(uid id, QString propertyName, QVariant value);
+  /**
+   * Returns the property changes of all elements since the last call (in the order elements
+   * were first changed) and clears them. Changes are not notified as they happen: they are
+   * recorded and meant to be delivered in batch (eg. once per frame), so that a property
+   * changing many times between two calls is only reported once.
+   */
+  static QList<PropertyChanges> takePropertyChanges();
 
 protected:
   virtual QList<QString> _propertiesAttributes() const
   { return Serializable::_propertiesAttributes() << "name" << "locked";  }
 
+  /// Records a change of property (see takePropertyChanges()).
   void _emitPropertyChanged(const QString& propertyName);
 
+  // Identifies an element in changes.
+  typedef QPair<const UidAllocator*, uid> ElementKey;
+
 private:
   uid _id;
   QString _name;
   bool _isLocked;
   float _opacity;
   UidAllocator* _allocator;
+
+  // Incremented whenever an element is renamed.
+  static quint64 _nameVersion;
+
+  // Changes since last call to takePropertyChanges() (in order of first change), and
+  // index of each changed element in it.
+  static QList<PropertyChanges> _propertyChanges;
+  static QHash<ElementKey, int> _propertyChangesIndex;
 };
 
 }
@@ -0,0 +1,278 @@
+/*
+ * FrameOutput.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameOutput.h"
+
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+
+#include <QDebug>
+
+#include "MM.h"
+
+namespace mmp {
+
+FrameOutput::FrameOutput()
+  : _pipeline(NULL),
+    _appsrc(NULL),
+    _finishingPipeline(NULL),
+    _active(false),
+    _framesPerSecond(MM::DEFAULT_FRAMES_PER_SECOND),
+    _firstTimestamp(0),
+    _frameCount(0),
+    _droppedFrameCount(0)
+{
+}
+
+FrameOutput::~FrameOutput()
+{
+  _freePipeline();
+
+  // Give a stopped output a last chance to be complete.
+  _freeFinishingPipeline(true);
+}
+
+bool FrameOutput::start(qreal framesPerSecond)
+{
+  stop();
+
+  // Previous pipeline might still be writing to the same destination.
+  _freeFinishingPipeline(true);
+
+  _framesPerSecond = (framesPerSecond > 0 ? framesPerSecond : MM::DEFAULT_FRAMES_PER_SECOND);
+  _size = QSize();
+  _frameCount = _droppedFrameCount = 0;
+  _error.clear();
+
+  _active = true;
+  return true;
+}
+
+void FrameOutput::stop()
+{
+  _finishPipeline();
+  _active = false;
+}
+
+bool FrameOutput::pollFinished()
+{
+  return _freeFinishingPipeline(false);
+}
+
+void FrameOutput::pushFrame(const uchar* bits, const QSize& size, qint64 timestamp)
+{
+  if (!_active)
+    return;
+
+  // Build pipeline on first frame.
+  if (!_pipeline)
+  {
+    if (!_createPipeline(size))
+    {
+      stop();
+      return;
+    }
+    _firstTimestamp = timestamp;
+  }
+
+  if (!_checkErrors())
+    return;
+
+  // Size changed (eg. render resolution or outputs changed).
+  if (size != _size)
+  {
+    if (!_supportsSizeChanges())
+    {
+      _error = QString("Output size changed from %1x%2 to %3x%4.")
+          .arg(_size.width()).arg(_size.height()).arg(size.width()).arg(size.height());
+      qWarning() << _error << endl;
+      stop();
+      return;
+    }
+
+    // Rebuild pipeline with new caps (pending frames of the old size are dropped).
+    _freePipeline();
+    if (!_createPipeline(size))
+    {
+      stop();
+      return;
+    }
+    _firstTimestamp = timestamp;
+  }
+
+  // Drop frame if the pipeline is late (never block the render loop).
+  if (gst_app_src_get_current_level_bytes(GST_APP_SRC(_appsrc)) >= gst_app_src_get_max_bytes(GST_APP_SRC(_appsrc)))
+  {
+    _droppedFrameCount++;
+    return;
+  }
+
+  // Copy frame into a new buffer (handed over to appsrc).
+  gsize nBytes = size.width() * size.height() * 4;
+  GstBuffer* buffer = gst_buffer_new_allocate(NULL, nBytes, NULL);
+  gst_buffer_fill(buffer, 0, bits, nBytes);
+  GST_BUFFER_PTS(buffer) = qMax(timestamp - _firstTimestamp, qint64(0));
+
+  if (gst_app_src_push_buffer(GST_APP_SRC(_appsrc), buffer) == GST_FLOW_OK)
+    _frameCount++;
+  else
+    _droppedFrameCount++;
+}
+
+bool FrameOutput::_createPipeline(const QSize& size)
+{
+  QString description = QString("appsrc name=src ! videoflip method=vertical-flip ! videoconvert ! %1").arg(_sinkDescription());
+
+  GError* error = NULL;
+  _pipeline = gst_parse_launch(description.toUtf8().constData(), &error);
+  if (error)
+  {
+    _error = QString::fromUtf8(error->message);
+    g_error_free(error);
+  }
+  if (!_pipeline)
+  {
+    qWarning() << "Could not create output pipeline: " << _error << endl;
+    return false;
+  }
+
+  _appsrc = gst_bin_get_by_name(GST_BIN(_pipeline), "src");
+  Q_CHECK_PTR(_appsrc);
+
+  // Raw frames as read back from GL.
+  GstCaps* caps = gst_caps_new_simple("video/x-raw",
+                                      "format", G_TYPE_STRING, "BGRA",
+                                      "width", G_TYPE_INT, size.width(),
+                                      "height", G_TYPE_INT, size.height(),
+                                      "framerate", GST_TYPE_FRACTION, qRound(_framesPerSecond * 1000), 1000,
+                                      NULL);
+  g_object_set(_appsrc,
+               "caps", caps,
+               "format", GST_FORMAT_TIME,
+               "is-live", TRUE,
+               "block", FALSE,
+               "max-bytes", (guint64) size.width() * size.height() * 4 * MM::FRAME_OUTPUT_MAX_QUEUED_FRAMES,
+               NULL);
+  gst_caps_unref(caps);
+
+  _configurePipeline(_pipeline, size);
+
+  if (gst_element_set_state(_pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+  {
+    _error = "Unable to start output pipeline.";
+    qWarning() << _error << endl;
+    _freePipeline();
+    return false;
+  }
+
+  _size = size;
+  return true;
+}
+
+void FrameOutput::_freePipeline()
+{
+  if (!_pipeline)
+    return;
+
+  gst_element_set_state(_pipeline, GST_STATE_NULL);
+  gst_object_unref(_appsrc);
+  gst_object_unref(_pipeline);
+  _appsrc = _pipeline = NULL;
+}
+
+void FrameOutput::_finishPipeline()
+{
+  if (!_pipeline)
+    return;
+
+  // Only one pipeline finishes at a time.
+  if (_finishingPipeline)
+    _freeFinishingPipeline(true);
+
+  // Let the pipeline process pending frames and finalize its output (eg. file headers).
+  gst_app_src_end_of_stream(GST_APP_SRC(_appsrc));
+  gst_object_unref(_appsrc);
+  _finishingPipeline = _pipeline;
+  _finishingTimer.start();
+  _appsrc = _pipeline = NULL;
+}
+
+bool FrameOutput::_freeFinishingPipeline(bool wait)
+{
+  if (!_finishingPipeline)
+    return false;
+
+  qint64 remaining = qMax(MM::FRAME_OUTPUT_EOS_TIMEOUT - _finishingTimer.elapsed(), qint64(0));
+  GstBus* bus = gst_element_get_bus(_finishingPipeline);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, wait ? remaining * GST_MSECOND : 0,
+                                               (GstMessageType) (GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  gst_object_unref(bus);
+
+  if (!msg)
+  {
+    // Not done yet.
+    if (!wait && remaining > 0)
+      return false;
+
+    // Output may be incomplete.
+    if (_error.isEmpty())
+      _error = "Timed out while finishing output (it may be incomplete).";
+    qWarning() << "Output pipeline did not finish in time." << endl;
+  }
+  else
+  {
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR && _error.isEmpty())
+    {
+      GError* error = NULL;
+      gst_message_parse_error(msg, &error, NULL);
+      _error = QString::fromUtf8(error->message);
+      g_error_free(error);
+    }
+    gst_message_unref(msg);
+  }
+
+  gst_element_set_state(_finishingPipeline, GST_STATE_NULL);
+  gst_object_unref(_finishingPipeline);
+  _finishingPipeline = NULL;
+  return true;
+}
+
+bool FrameOutput::_checkErrors()
+{
+  GstBus* bus = gst_element_get_bus(_pipeline);
+  GstMessage* msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+  gst_object_unref(bus);
+  if (!msg)
+    return true;
+
+  GError* error = NULL;
+  gchar* debug = NULL;
+  gst_message_parse_error(msg, &error, &debug);
+  _error = QString::fromUtf8(error->message);
+  qWarning() << "Output pipeline error: " << _error << " (" << debug << ")" << endl;
+  g_error_free(error);
+  g_free(debug);
+  gst_message_unref(msg);
+
+  _freePipeline();
+  _active = false;
+  return false;
+}
+
+}
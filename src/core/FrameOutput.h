@@ -0,0 +1,140 @@
+/*
+ * FrameOutput.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_OUTPUT_H_
+#define FRAME_OUTPUT_H_
+
+#include <QElapsedTimer>
+#include <QSize>
+#include <QString>
+#include <QtGlobal>
+
+// Keep GStreamer headers out of the rest of the project (see VideoImpl).
+typedef struct _GstElement GstElement;
+
+namespace mmp {
+
+/**
+ * Sends composed frames into a GStreamer pipeline starting with an appsrc
+ * (appsrc ! videoflip ! videoconvert ! <sink>).
+ *
+ * Pushing a frame only copies it into a GStreamer buffer: conversion, encoding
+ * and writing happen on the streaming thread of the appsrc, so the render loop
+ * never waits for them. When the pipeline cannot keep up (more than
+ * MM::FRAME_OUTPUT_MAX_QUEUED_FRAMES waiting) frames are dropped and counted.
+ *
+ * Stopping never blocks either: the pipeline is sent an end-of-stream and keeps
+ * finishing its output in the background until pollFinished() sees it done.
+ *
+ * The pipeline is built on the first frame pushed after start(), using its size.
+ * When frames change size, outputs that support it (see _supportsSizeChanges())
+ * rebuild their pipeline for the new size; others stop with an error.
+ */
+class FrameOutput
+{
+public:
+  FrameOutput();
+  virtual ~FrameOutput();
+
+  /// Starts accepting frames (framesPerSecond is only a hint for the caps). Returns false on error.
+  bool start(qreal framesPerSecond);
+
+  /// Stops accepting frames and lets the pipeline finish with pending ones (see pollFinished()).
+  void stop();
+
+  /// Returns true iff started.
+  bool isActive() const { return _active; }
+
+  /// Returns true iff a stopped pipeline is still finishing its output.
+  bool isFinishing() const { return _finishingPipeline != NULL; }
+
+  /**
+   * Checks (without blocking) whether the stopped pipeline is done, in which case it is
+   * freed. Pipelines that take more than MM::FRAME_OUTPUT_EOS_TIMEOUT are freed anyway
+   * (with an error). Returns true iff the pipeline finished during this call.
+   */
+  bool pollFinished();
+
+  /**
+   * Pushes a frame of 32-bit BGRA pixels stored bottom-up (as read back from GL),
+   * displayed at timestamp (in nanoseconds, any origin).
+   */
+  void pushFrame(const uchar* bits, const QSize& size, qint64 timestamp);
+
+  /// Returns the number of frames sent since start().
+  int getFrameCount() const { return _frameCount; }
+
+  /// Returns the number of frames dropped since start().
+  int getDroppedFrameCount() const { return _droppedFrameCount; }
+
+  /// Returns the size of frames (invalid until first frame).
+  const QSize& getSize() const { return _size; }
+
+  /// Returns the last error message (empty if none).
+  const QString& getError() const { return _error; }
+
+protected:
+  /// Returns the description (gst-launch syntax) of the elements receiving the raw video.
+  virtual QString _sinkDescription() const = 0;
+
+  /// Called once the pipeline has been created for frames of given size, before it is started (eg. to set properties).
+  virtual void _configurePipeline(GstElement* pipeline, const QSize& size) { Q_UNUSED(pipeline); Q_UNUSED(size); }
+
+  /// Returns true iff the output can restart with a new pipeline when the size of frames changes.
+  virtual bool _supportsSizeChanges() const { return false; }
+
+private:
+  // Creates and starts pipeline for frames of given size.
+  bool _createPipeline(const QSize& size);
+
+  // Frees pipeline right away (pending frames are lost).
+  void _freePipeline();
+
+  // Sends end-of-stream to pipeline and hands it over to _finishingPipeline.
+  void _finishPipeline();
+
+  // Frees _finishingPipeline, waiting at most what is left of MM::FRAME_OUTPUT_EOS_TIMEOUT
+  // for it to be done if wait is true. Returns true iff freed.
+  bool _freeFinishingPipeline(bool wait);
+
+  // Stops on pipeline errors.
+  bool _checkErrors();
+
+  GstElement* _pipeline;
+  GstElement* _appsrc;
+
+  // Stopped pipeline processing its last frames (and time since it was stopped).
+  GstElement* _finishingPipeline;
+  QElapsedTimer _finishingTimer;
+
+  bool _active;
+  qreal _framesPerSecond;
+  QSize _size;
+
+  // Timestamp of first frame (pipeline time starts there).
+  qint64 _firstTimestamp;
+
+  int _frameCount;
+  int _droppedFrameCount;
+  QString _error;
+};
+
+}
+
+#endif /* FRAME_OUTPUT_H_ */
@@ -68,7 +68,12 @@ const qreal MM::ZOOM_FACTOR = 1.4f;
 const qreal MM::ZOOM_MIN    = 0.1f;
 const qreal MM::ZOOM_MAX    = 5.0f;
 
+// Misc.
+const qreal MM::COLOR_ANTIALIASING_WIDTH = 1.0f;
+
 // Default values
 const QString MM::DEFAULT_LANGUAGE = "en";
+const qreal MM::DEFAULT_RENDER_SCALE = 1.0f;
+const QString MM::DEFAULT_SHARED_MEMORY_OUTPUT_PATH = "/tmp/mapmap-output";
 
 }
@@ -72,6 +72,7 @@ public:
 
   // OSC
   static const int DEFAULT_OSC_PORT = 12345;
+  static const int NAME_PATTERN_CACHE_SIZE = 64; // name patterns kept compiled (with their matches)
 
   // Default values
   static const bool DISPLAY_TEST_SIGNAL = false;
@@ -88,6 +89,10 @@ public:
   static const bool SHOW_OUTPUT_ON_MOUSE_HOVER = true;
   static const bool OSC_SAME_MEDIA_SOURCE = false;
   static const bool PLAY_IN_LOOP = true;
+  static const bool NATIVE_OUTPUT_RENDERING = false;
+  static const qreal DEFAULT_RENDER_SCALE; // internal render resolution relative to output
+  static const bool SHARED_MEMORY_OUTPUT = false;
+  static const QString DEFAULT_SHARED_MEMORY_OUTPUT_PATH;
 
   // Style.
   static const QColor WHITE;
@@ -129,6 +134,14 @@ public:
   static const int MESH_SUBDIVISION_MAX_DEPTH_EDITING = 4;
   static const int MESH_SUBDIVISION_MAX_DEPTH         = (-1);
   static const int ELLIPSE_N_TRIANGLES = 100; // n triangles used to draw an ellipse
+  static const qreal COLOR_ANTIALIASING_WIDTH; // width of the fading edge of color mappings
+  static const int FRAME_READER_N_BUFFERS = 3; // pixel buffers used to read back frames asynchronously
+  static const int OUTPUT_CORRECTION_MAX_WARP_SIZE = 16; // max number of columns/rows of output warp grids
+  static const int FRAME_OUTPUT_MAX_QUEUED_FRAMES = 4; // frames waiting in an output pipeline before dropping
+  static const int FRAME_OUTPUT_EOS_TIMEOUT = 1000; // max time (ms) given to a stopped output pipeline to finish
+  static const int SPATIAL_INDEX_CELL_SIZE = 64; // size of the cells used to index shapes for hit-testing
+  static const int SPATIAL_INDEX_MAX_SHAPE_CELLS = 1024; // shapes covering more cells are always tested
+  static const int UID_ALLOCATOR_MAX_BITMAP_SIZE = (1 << 20); // ids above are tracked in a set (eg. large ids read from files)
 
   // Enumerations
   enum ItemColumn {
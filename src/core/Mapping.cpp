@@ -26,6 +26,8 @@ namespace mmp {
 
 UidAllocator Mapping::allocator;
 
+quint64 Mapping::_visibilityVersion = 0;
+
 Mapping::Mapping(uid id)
 : Mapping(Paint::ptr(), MShape::ptr(), MShape::ptr(), id) {}
 
@@ -53,6 +55,7 @@ void Mapping::setSolo(bool solo)
   if (solo != _isSolo)
   {
     _isSolo = solo;
+    _visibilityVersion++;
     _emitPropertyChanged("solo");
   }
 }
@@ -62,6 +65,7 @@ void Mapping::setVisible(bool visible)
   if (visible != _isVisible)
   {
     _isVisible = visible;
+    _visibilityVersion++;
     _emitPropertyChanged("visible");
   }
 }
@@ -88,7 +92,12 @@ void Mapping::setPaint(Paint::ptr paint)
 {
 	if (paintIsCompatible(paint))
 	{
+		Paint::ptr oldPaint = _paint;
 		_paint = paint;
+		_visibilityVersion++;
+
+		// Keep track of which mappings use which paints.
+		MainWindow::window()->getMappingManager().mappingPaintChanged(this, oldPaint);
 	  _emitPropertyChanged("paintId");
 	}
 }
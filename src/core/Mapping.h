@@ -80,6 +80,9 @@ protected:
 private:
   static UidAllocator allocator;
 
+  // Incremented whenever the visibility of a mapping changes.
+  static quint64 _visibilityVersion;
+
   bool _isSolo;
   bool _isVisible;
   int _depth; // depth of the layer
@@ -97,6 +100,13 @@ public:
 
   static const UidAllocator& getUidAllocator() { return allocator; }
 
+  /**
+   * Returns a number that changes every time the visibility of any mapping may have
+   * changed (solo, visible or paint properties). Allows caches of visible mappings
+   * to check their validity with a single comparison.
+   */
+  static quint64 getVisibilityVersion() { return _visibilityVersion; }
+
   /**
    * Sets up this Mapping: its Paint and its Shape.
    * Calls the build() method of its Paint and Shape.
@@ -24,33 +24,23 @@
 namespace mmp {
 
 MappingManager::MappingManager()
+  : _version(0), _visibilityCacheValid(false), _visibilityCacheVersion(0), _nSoloMappings(0)
 {
-  // TODO Auto-generated constructor stub
-
 }
 
 QMap<uid, Mapping::ptr> MappingManager::getPaintMappings(const Paint::ptr paint) const
 {
-  QMap<uid, Mapping::ptr> paintMappings;
-  for (QVector<Mapping::ptr>::const_iterator it = mappingVector.begin(); it != mappingVector.end(); ++it)
-  {
-    if ((*it)->getPaint() == paint)
-    {
-      paintMappings[(*it)->getId()] = *it;
-    }
-  }
-  return paintMappings;
+  return (paint.isNull() ? QMap<uid, Mapping::ptr>() : getPaintMappingsById(paint->getId()));
 }
 
-
 Paint::ptr MappingManager::getPaintByName(QString name)
 {
-  return _getElementByName(paintVector, name);
+  return paintNameIndex.getByName(paintVector, name);
 }
 
 QVector<Paint::ptr> MappingManager::getPaintsByNameRegExp(QString namePattern)
 {
-  return _getElementsByNameRegExp(paintVector, namePattern);
+  return paintNameIndex.getByNamePattern(paintVector, namePattern);
 }
 
 QVector<Paint::ptr> MappingManager::getPaintsCompatibleWith(Mapping::ptr mapping)
@@ -66,23 +56,25 @@ QVector<Paint::ptr> MappingManager::getPaintsCompatibleWith(Mapping::ptr mapping
 
 Mapping::ptr MappingManager::getMappingByName(QString name)
 {
-  return _getElementByName(mappingVector, name);
+  return mappingNameIndex.getByName(mappingVector, name);
 }
 
 QVector<Mapping::ptr> MappingManager::getMappingsByNameRegExp(QString namePattern)
 {
-  return _getElementsByNameRegExp(mappingVector, namePattern);
+  return mappingNameIndex.getByNamePattern(mappingVector, namePattern);
 }
 
 QMap<uid, Mapping::ptr> MappingManager::getPaintMappingsById(uid paintId) const
 {
-  return getPaintMappings(paintMap[paintId]);
+  // Maps are implicitly shared so this does not copy anything.
+  return paintMappingsMap.value(paintId);
 }
 
 uid MappingManager::addPaint(Paint::ptr paint)
 {
   paintVector.push_back(paint);
   paintMap[paint->getId()] = paint;
+  paintNameIndex.invalidate();
   return paint->getId();
 }
 
@@ -105,6 +97,8 @@ bool MappingManager::removePaint(uid paintId)
     Q_ASSERT(idx != -1);
     paintVector.remove(idx);
     paintMap.remove(paintId);
+    paintNameIndex.invalidate();
+    paintMappingsMap.remove(paintId);
     return true;
   }
   else
@@ -141,6 +135,8 @@ uid MappingManager::addMapping(Mapping::ptr mapping)
 
   mappingVector.push_back(mapping);
   mappingMap[mapping->getId()] = mapping;
+  _indexPaintMapping(mapping->getPaint(), mapping);
+  _mappingsChanged();
 
   return mapping->getId();
 }
@@ -155,6 +151,8 @@ bool MappingManager::removeMapping(uid mappingId)
     Q_ASSERT( idx != -1 ); // Q_ASSERT(mappingVector.contains(mapping));
     mappingVector.remove(idx);
     mappingMap.remove(mappingId);
+    _unindexPaintMapping(mapping->getPaint(), mappingId);
+    _mappingsChanged();
 
     return true;
   }
@@ -164,35 +162,101 @@ bool MappingManager::removeMapping(uid mappingId)
   }
 }
 
-QVector<Mapping::ptr> MappingManager::getVisibleMappings() const
+QVector<uid> MappingManager::addMappings(const QVector<Mapping::ptr>& mappings)
 {
-  QVector<Mapping::ptr> visible;
+  QVector<uid> mappingIds;
+  mappingIds.reserve(mappings.size());
+  mappingVector.reserve(mappingVector.size() + mappings.size());
+  foreach (Mapping::ptr mapping, mappings)
+  {
+    // Make sure the paint to which this mapping refers to exists in the manager.
+    Q_ASSERT ( paintMap.contains(mapping->getPaint()->getId()) );
 
-  // First pass: check if one of the mappings is in solo mode.
-  bool hasSolo = false;
-  for (QVector<Mapping::ptr>::const_iterator it = mappingVector.begin();
-          it != mappingVector.end(); ++it)
+    mappingVector.push_back(mapping);
+    mappingMap[mapping->getId()] = mapping;
+    _indexPaintMapping(mapping->getPaint(), mapping);
+    mappingIds.push_back(mapping->getId());
+  }
+
+  if (!mappings.isEmpty())
+    _mappingsChanged();
+
+  return mappingIds;
+}
+
+int MappingManager::removeMappings(const QVector<uid>& mappingIds)
+{
+  // Remove mappings from maps and indices.
+  int nRemoved = 0;
+  foreach (uid mappingId, mappingIds)
   {
-    if ((*it)->isSolo())
+    Mapping::ptr mapping = mappingMap.take(mappingId);
+    if (mapping)
     {
-      hasSolo = true;
-      break;
+      _unindexPaintMapping(mapping->getPaint(), mappingId);
+      nRemoved++;
     }
   }
 
-  // Second pass: fill the visible vector.
-  for (QVector<Mapping::ptr>::const_iterator it = mappingVector.begin();
-          it != mappingVector.end(); ++it)
+  if (nRemoved > 0)
   {
-    // Solo has priority over invisible (mute)
-    if ( (hasSolo && (*it)->isSolo()) ||
-         (! hasSolo && (*it)->isVisible()) )
+    // Compact mapping vector (keeping order of remaining mappings).
+    int n = 0;
+    for (int i=0; i<mappingVector.size(); i++)
     {
-      visible.push_back(*it);
+      const Mapping::ptr& mapping = mappingVector[i];
+      if (mappingMap.value(mapping->getId()) == mapping)
+        mappingVector[n++] = mapping;
     }
+    mappingVector.resize(n);
+    _mappingsChanged();
+  }
+
+  return nRemoved;
+}
+
+void MappingManager::mappingPaintChanged(Mapping* mapping, Paint::ptr oldPaint)
+{
+  // Only index mappings that belong to this manager.
+  Mapping::ptr managedMapping = mappingMap.value(mapping->getId());
+  if (managedMapping.data() != mapping)
+    return;
+
+  _unindexPaintMapping(oldPaint, mapping->getId());
+  _indexPaintMapping(mapping->getPaint(), managedMapping);
+}
+
+void MappingManager::_mappingsChanged()
+{
+  _version++;
+  mappingNameIndex.invalidate();
+  _visibilityCacheValid = false;
+}
+
+void MappingManager::_indexPaintMapping(Paint::ptr paint, Mapping::ptr mapping)
+{
+  if (!paint.isNull())
+    paintMappingsMap[paint->getId()].insert(mapping->getId(), mapping);
+}
+
+void MappingManager::_unindexPaintMapping(Paint::ptr paint, uid mappingId)
+{
+  if (paint.isNull())
+    return;
+
+  QHash<uid, QMap<uid, Mapping::ptr> >::iterator it = paintMappingsMap.find(paint->getId());
+  if (it != paintMappingsMap.end())
+  {
+    it->remove(mappingId);
+    if (it->isEmpty())
+      paintMappingsMap.erase(it);
   }
+}
 
-  return visible;
+QVector<Mapping::ptr> MappingManager::getVisibleMappings() const
+{
+  _updateVisibility();
+  return _visibleMappings;
 }
 
 /// Returns true iff the mapping is visible.
@@ -210,37 +274,68 @@ bool MappingManager::mappingIsVisible(Mapping::ptr mapping) const
     return false;
   }
 
-  // Mapping is non-solo yet visible: check if another mapping is solo
-  // (which would thus make it invisible).
+  // Mapping is non-solo yet visible: it is visible unless another mapping is solo.
   else
   {
-    for (QVector<Mapping::ptr>::const_iterator it = mappingVector.begin();
-            it != mappingVector.end(); ++it)
-    {
-      if ((*it)->isSolo())
-      {
-        return false;
-      }
-    }
-
-    // Mapping is non-solo yet visible and there are no solo mappings.
-    return true;
+    _updateVisibility();
+    return (_nSoloMappings == 0);
   }
 }
 
 /// Returns the list of visible paints (ie. paints for which at least one mapping is visible).
 QVector<Paint::ptr> MappingManager::getVisiblePaints() const
 {
-  QVector<Paint::ptr> visiblePaints;
-  QVector<Mapping::ptr> visibleMappings = getVisibleMappings();
-  for (QVector<Mapping::ptr>::const_iterator it = visibleMappings.begin();
-          it != visibleMappings.end(); ++it)
+  _updateVisibility();
+  return _visiblePaints;
+}
+
+bool MappingManager::paintIsVisible(Paint::ptr paint) const
+{
+  _updateVisibility();
+  return _visiblePaintSet.contains(paint.data());
+}
+
+void MappingManager::_updateVisibility() const
+{
+  // Check if cache is still up to date.
+  quint64 version = Mapping::getVisibilityVersion();
+  if (_visibilityCacheValid && _visibilityCacheVersion == version)
+    return;
+
+  // First pass: count mappings in solo mode.
+  _nSoloMappings = 0;
+  for (QVector<Mapping::ptr>::const_iterator it = mappingVector.begin();
+          it != mappingVector.end(); ++it)
+  {
+    if ((*it)->isSolo())
+      _nSoloMappings++;
+  }
+
+  // Second pass: fill the visible mappings and paints.
+  _visibleMappings.resize(0);
+  _visiblePaints.resize(0);
+  _visiblePaintSet.clear();
+  bool hasSolo = (_nSoloMappings > 0);
+  for (QVector<Mapping::ptr>::const_iterator it = mappingVector.begin();
+          it != mappingVector.end(); ++it)
   {
-    Paint::ptr paint((*it)->getPaint());
-    if (!visiblePaints.contains(paint))
-      visiblePaints.push_back(paint);
+    // Solo has priority over invisible (mute)
+    if ( (hasSolo && (*it)->isSolo()) ||
+         (! hasSolo && (*it)->isVisible()) )
+    {
+      _visibleMappings.push_back(*it);
+
+      Paint::ptr paint((*it)->getPaint());
+      if (!_visiblePaintSet.contains(paint.data()))
+      {
+        _visiblePaintSet.insert(paint.data());
+        _visiblePaints.push_back(paint);
+      }
+    }
   }
-  return visiblePaints;
+
+  _visibilityCacheVersion = version;
+  _visibilityCacheValid = true;
 }
 
 void MappingManager::reorderMappings(QVector<uid> mappingIds)
@@ -263,6 +358,7 @@ void MappingManager::reorderMappings(QVector<uid> mappingIds)
 
     depth++;
   }
+  _mappingsChanged();
 }
 
 //bool MappingManager::removeMapping(Mapping::ptr mapping)
@@ -275,6 +371,9 @@ void MappingManager::clearAll()
   mappingVector.clear();
   paintMap.clear();
   mappingMap.clear();
+  paintMappingsMap.clear();
+  paintNameIndex.invalidate();
+  _mappingsChanged();
 }
 
 }
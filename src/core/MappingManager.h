@@ -22,10 +22,13 @@
 #define MAPPINGMANAGER_H_
 
 #include <QVector>
+#include <QHash>
 #include <QMap>
+#include <QSet>
 
 #include "Paint.h"
 #include "Mapping.h"
+#include "NameIndex.h"
 
 namespace mmp {
 
@@ -53,6 +56,13 @@ private:
   /// Maps from uids to mappings.
   QMap<uid, Mapping::ptr> mappingMap;
 
+  /// Name indices of paints and mappings.
+  NameIndex<Paint> paintNameIndex;
+  NameIndex<Mapping> mappingNameIndex;
+
+  /// Maps from paint uids to the mappings using them.
+  QHash<uid, QMap<uid, Mapping::ptr> > paintMappingsMap;
+
 public:
   /// Returns the list of mappings associated with given paint.
   QMap<uid, Mapping::ptr> getPaintMappings(const Paint::ptr paint) const;
@@ -96,6 +106,15 @@ public:
   /// Removes a mapping of given uid.
   bool removeMapping(uid mappingId);
 
+  /// Adds mappings (in order, on top of existing ones) and returns their uids.
+  QVector<uid> addMappings(const QVector<Mapping::ptr>& mappings);
+
+  /// Removes mappings of given uids in a single pass and returns the number of mappings removed.
+  int removeMappings(const QVector<uid>& mappingIds);
+
+  /// Updates the paint-to-mappings index after the paint of mapping changed (called by Mapping::setPaint()).
+  void mappingPaintChanged(Mapping* mapping, Paint::ptr oldPaint);
+
   /// Returns the number of mappings.
   int nMappings() const { return mappingVector.size(); }
 
@@ -126,37 +145,35 @@ public:
   /// Returns the list of visible paints (ie. paints for which at least one mapping is visible).
   QVector<Paint::ptr> getVisiblePaints() const;
 
+  /// Returns true iff at least one mapping of paint is visible.
+  bool paintIsVisible(Paint::ptr paint) const;
+
+  /// Returns a number that changes every time mappings are added, removed or reordered.
+  quint64 getVersion() const { return _version; }
+
   void clearAll();
 
 private:
-  template<class T>
-  QSharedPointer<T> _getElementByName(const QVector<QSharedPointer<T> >& vector, QString name)
-  {
-    for (QSharedPointer<T> it: vector)
-    {
-      if (it->getName() == name)
-      {
-        return it;
-      }
-    }
-    // Nothing found.
-    return QSharedPointer<T>();
-  }
-
-  template<class T>
-  QVector<QSharedPointer<T> > _getElementsByNameRegExp(const QVector<QSharedPointer<T> >& vector, QString namePattern)
-  {
-    QVector<QSharedPointer<T> > matchedElems;
-    QRegExp regExp(namePattern, Qt::CaseSensitive, QRegExp::Wildcard);
-    for (QSharedPointer<T> it: vector)
-    {
-      if (regExp.exactMatch(it->getName()))
-      {
-        matchedElems.push_back(it);
-      }
-    }
-    return matchedElems;
-  }
+  // Adds/removes mapping to/from the mappings of paint in the paint index.
+  void _indexPaintMapping(Paint::ptr paint, Mapping::ptr mapping);
+  void _unindexPaintMapping(Paint::ptr paint, uid mappingId);
+
+  // Must be called whenever mappings are added, removed or reordered.
+  void _mappingsChanged();
+
+  // Rebuilds visibility cache if mappings were modified since last time.
+  void _updateVisibility() const;
+
+  // Incremented whenever mappings are added, removed or reordered.
+  quint64 _version;
+
+  // Visibility cache (rebuilt lazily so that queries from paint() are constant-time).
+  mutable bool _visibilityCacheValid;
+  mutable quint64 _visibilityCacheVersion;
+  mutable int _nSoloMappings;
+  mutable QVector<Mapping::ptr> _visibleMappings;
+  mutable QVector<Paint::ptr> _visiblePaints;
+  mutable QSet<Paint*> _visiblePaintSet;
 };
 
 }
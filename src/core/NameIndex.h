@@ -0,0 +1,174 @@
+/*
+ * NameIndex.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAME_INDEX_H_
+#define NAME_INDEX_H_
+
+#include <QCache>
+#include <QHash>
+#include <QMap>
+#include <QRegExp>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <algorithm>
+
+#include "Element.h"
+#include "MM.h"
+
+namespace mmp {
+
+/**
+ * Index of a vector of elements by name, used to resolve the (wildcard) name patterns
+ * used to address elements (eg. through OSC).
+ *
+ * Exact names are looked up in a hash. Patterns are only tested against the names that
+ * start with their literal prefix (found through a sorted map), and the most recently
+ * used patterns are kept compiled along with their matches. The index is rebuilt lazily
+ * when invalidated (ie. when elements are added or removed) or when any element is
+ * renamed; matches always follow the order of the indexed vector.
+ */
+template<class T>
+class NameIndex
+{
+public:
+  typedef QSharedPointer<T> ElementPtr;
+
+  NameIndex() : _isValid(false), _nameVersion(0), _generation(0)
+  {
+    _patterns.setMaxCost(MM::NAME_PATTERN_CACHE_SIZE);
+  }
+
+  /// Must be called whenever elements are added to or removed from the indexed vector.
+  void invalidate() { _isValid = false; }
+
+  /// Returns first element of vector with given name (or null if there is none).
+  ElementPtr getByName(const QVector<ElementPtr>& elements, const QString& name)
+  {
+    _update(elements);
+    typename QHash<QString, QVector<int> >::const_iterator it = _names.constFind(name);
+    return (it == _names.constEnd() ? ElementPtr() : elements[it->first()]);
+  }
+
+  /// Returns all elements of vector whose name matches wildcard pattern.
+  QVector<ElementPtr> getByNamePattern(const QVector<ElementPtr>& elements, const QString& namePattern)
+  {
+    _update(elements);
+
+    Pattern* pattern = _patterns.object(namePattern);
+    if (!pattern)
+    {
+      pattern = new Pattern(namePattern);
+      _patterns.insert(namePattern, pattern);
+    }
+
+    // Resolve pattern again if index changed since last time.
+    if (pattern->generation != _generation)
+    {
+      pattern->matches = _resolve(elements, *pattern);
+      pattern->generation = _generation;
+    }
+    return pattern->matches;
+  }
+
+private:
+  // A compiled pattern and its resolved matches.
+  struct Pattern
+  {
+    Pattern(const QString& namePattern)
+      : regExp(namePattern, Qt::CaseSensitive, QRegExp::Wildcard), generation(0)
+    {
+      // Literal part of pattern before the first wildcard.
+      int wildcard = namePattern.indexOf(QRegExp("[*?\\[]"));
+      isExact  = (wildcard == -1);
+      prefix = (isExact ? namePattern : namePattern.left(wildcard));
+    }
+
+    QRegExp regExp;
+    QString prefix;
+    bool isExact;
+    QVector<ElementPtr> matches;
+    quint64 generation;
+  };
+
+  // Rebuilds index if elements were added, removed or renamed.
+  void _update(const QVector<ElementPtr>& elements)
+  {
+    quint64 nameVersion = Element::getNameVersion();
+    if (_isValid && _nameVersion == nameVersion)
+      return;
+
+    _names.clear();
+    for (int i=0; i<elements.size(); i++)
+      _names[elements[i]->getName()].append(i);
+
+    _sortedNames.clear();
+    for (typename QHash<QString, QVector<int> >::const_iterator it = _names.constBegin();
+         it != _names.constEnd(); ++it)
+      _sortedNames.insert(it.key(), it.value());
+
+    _isValid = true;
+    _nameVersion = nameVersion;
+    _generation++;
+  }
+
+  // Returns elements matching pattern.
+  QVector<ElementPtr> _resolve(const QVector<ElementPtr>& elements, const Pattern& pattern) const
+  {
+    QVector<int> indices;
+    if (pattern.isExact)
+      indices = _names.value(pattern.prefix);
+    else
+    {
+      // Only test names sharing the literal prefix of the pattern.
+      for (typename QMap<QString, QVector<int> >::const_iterator it = _sortedNames.lowerBound(pattern.prefix);
+           it != _sortedNames.constEnd() && it.key().startsWith(pattern.prefix); ++it)
+      {
+        if (pattern.regExp.exactMatch(it.key()))
+          indices += it.value();
+      }
+      std::sort(indices.begin(), indices.end());
+    }
+
+    QVector<ElementPtr> matches;
+    matches.reserve(indices.size());
+    for (int i: indices)
+      matches.append(elements[i]);
+    return matches;
+  }
+
+  bool _isValid;
+  quint64 _nameVersion;
+
+  // Incremented each time the index is rebuilt (invalidates matches of cached patterns).
+  quint64 _generation;
+
+  // Indices in vector of elements of each name, in increasing order.
+  QHash<QString, QVector<int> > _names;
+
+  // Same, sorted by name (for prefix queries).
+  QMap<QString, QVector<int> > _sortedNames;
+
+  // Most recently used patterns.
+  QCache<QString, Pattern> _patterns;
+};
+
+}
+
+#endif /* NAME_INDEX_H_ */
@@ -0,0 +1,126 @@
+/*
+ * OutputCorrection.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OutputCorrection.h"
+
+#include <QDebug>
+
+#include "MM.h"
+
+namespace mmp {
+
+OutputCorrection::OutputCorrection()
+  : _blendLeft(0), _blendRight(0), _blendTop(0), _blendBottom(0), _blendGamma(2.2f)
+{
+  resetWarp();
+}
+
+void OutputCorrection::resetWarp(int columns, int rows)
+{
+  _warpColumns = qBound(1, columns, int(MM::OUTPUT_CORRECTION_MAX_WARP_SIZE));
+  _warpRows    = qBound(1, rows,    int(MM::OUTPUT_CORRECTION_MAX_WARP_SIZE));
+
+  _warpPoints.resize((_warpColumns+1) * (_warpRows+1));
+  for (int row=0; row<=_warpRows; row++)
+    for (int column=0; column<=_warpColumns; column++)
+      setWarpPoint(column, row, QPointF(qreal(column) / _warpColumns, qreal(row) / _warpRows));
+}
+
+QPointF OutputCorrection::mapWarp(const QPointF& point) const
+{
+  // Find cell.
+  qreal x = qBound(qreal(0), point.x(), qreal(1)) * _warpColumns;
+  qreal y = qBound(qreal(0), point.y(), qreal(1)) * _warpRows;
+  int column = qMin(int(x), _warpColumns-1);
+  int row    = qMin(int(y), _warpRows-1);
+  qreal u = x - column;
+  qreal v = y - row;
+
+  // Bilinear interpolation of cell corners.
+  QPointF top    = getWarpPoint(column, row)   * (1-u) + getWarpPoint(column+1, row)   * u;
+  QPointF bottom = getWarpPoint(column, row+1) * (1-u) + getWarpPoint(column+1, row+1) * u;
+  return top * (1-v) + bottom * v;
+}
+
+bool OutputCorrection::hasWarp() const
+{
+  for (int row=0; row<=_warpRows; row++)
+    for (int column=0; column<=_warpColumns; column++)
+      if (getWarpPoint(column, row) != QPointF(qreal(column) / _warpColumns, qreal(row) / _warpRows))
+        return true;
+  return false;
+}
+
+bool OutputCorrection::hasBlend() const
+{
+  return (_blendLeft > 0 || _blendRight > 0 || _blendTop > 0 || _blendBottom > 0);
+}
+
+void OutputCorrection::read(const QDomElement& obj)
+{
+  // Read blend parameters.
+  Serializable::read(obj);
+
+  // Read warp grid.
+  QDomElement warpObj = obj.firstChildElement("warp");
+  bool columnsOk, rowsOk;
+  int columns = warpObj.attribute("columns", "1").toInt(&columnsOk);
+  int rows    = warpObj.attribute("rows", "1").toInt(&rowsOk);
+  if (!columnsOk || !rowsOk ||
+      columns < 1 || columns > MM::OUTPUT_CORRECTION_MAX_WARP_SIZE ||
+      rows < 1    || rows > MM::OUTPUT_CORRECTION_MAX_WARP_SIZE)
+  {
+    // Invalid grid: ignore warp.
+    qWarning() << "Invalid output warp grid size: " << warpObj.attribute("columns") << "x" << warpObj.attribute("rows") << endl;
+    resetWarp();
+    return;
+  }
+  resetWarp(columns, rows);
+
+  QDomNode pointNode = warpObj.firstChild();
+  for (int i=0; i<_warpPoints.size() && !pointNode.isNull(); i++)
+  {
+    const QDomElement& pointElem = pointNode.toElement();
+    _warpPoints[i] = QPointF(pointElem.attribute("x").toDouble(), pointElem.attribute("y").toDouble());
+
+    pointNode = pointNode.nextSibling();
+  }
+}
+
+void OutputCorrection::write(QDomElement& obj)
+{
+  // Write blend parameters.
+  Serializable::write(obj);
+
+  // Write warp grid.
+  QDomElement warpObj = obj.ownerDocument().createElement("warp");
+  warpObj.setAttribute("columns", QString::number(_warpColumns));
+  warpObj.setAttribute("rows", QString::number(_warpRows));
+  for (int i=0; i<_warpPoints.size(); i++)
+  {
+    QDomElement pointObj = obj.ownerDocument().createElement("point");
+    pointObj.setAttribute("x", QString::number(_warpPoints[i].x()));
+    pointObj.setAttribute("y", QString::number(_warpPoints[i].y()));
+    warpObj.appendChild(pointObj);
+  }
+
+  obj.appendChild(warpObj);
+}
+
+}
@@ -0,0 +1,110 @@
+/*
+ * OutputCorrection.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUT_CORRECTION_H_
+#define OUTPUT_CORRECTION_H_
+
+#include <QPointF>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "Serializable.h"
+
+namespace mmp {
+
+/**
+ * Final correction applied to the composition by one output (ie. one projector):
+ * a grid warp and soft edge-blend ramps.
+ *
+ * All coordinates are normalized to the output ([0, 1] x [0, 1]). Warp points tell
+ * where each point of a regular grid over the output gets displayed; the image is
+ * interpolated bilinearly in between. Blend widths are the fraction of the output
+ * over which each edge fades to black; ramps are gamma-corrected (blendGamma being
+ * the gamma of the projector) so that overlapping outputs add up to even brightness.
+ */
+class OutputCorrection : public Serializable
+{
+  Q_OBJECT
+
+  Q_PROPERTY(float blendLeft   READ getBlendLeft   WRITE setBlendLeft)
+  Q_PROPERTY(float blendRight  READ getBlendRight  WRITE setBlendRight)
+  Q_PROPERTY(float blendTop    READ getBlendTop    WRITE setBlendTop)
+  Q_PROPERTY(float blendBottom READ getBlendBottom WRITE setBlendBottom)
+  Q_PROPERTY(float blendGamma  READ getBlendGamma  WRITE setBlendGamma)
+
+public:
+  typedef QSharedPointer<OutputCorrection> ptr;
+
+  Q_INVOKABLE OutputCorrection();
+  virtual ~OutputCorrection() {}
+
+  /// Resets warp to an identity grid of given number of cells (in [1, MM::OUTPUT_CORRECTION_MAX_WARP_SIZE]).
+  void resetWarp(int columns = 1, int rows = 1);
+
+  int getWarpColumns() const { return _warpColumns; }
+  int getWarpRows() const { return _warpRows; }
+
+  /// Returns warp point at given grid position (column in [0, warpColumns], row in [0, warpRows]).
+  QPointF getWarpPoint(int column, int row) const { return _warpPoints[row*(_warpColumns+1) + column]; }
+  void setWarpPoint(int column, int row, const QPointF& point) { _warpPoints[row*(_warpColumns+1) + column] = point; }
+
+  /// Returns where normalized output point gets displayed once warped.
+  QPointF mapWarp(const QPointF& point) const;
+
+  float getBlendLeft() const   { return _blendLeft; }
+  float getBlendRight() const  { return _blendRight; }
+  float getBlendTop() const    { return _blendTop; }
+  float getBlendBottom() const { return _blendBottom; }
+  float getBlendGamma() const  { return _blendGamma; }
+
+  void setBlendLeft(float width)   { _blendLeft   = _clampBlend(width); }
+  void setBlendRight(float width)  { _blendRight  = _clampBlend(width); }
+  void setBlendTop(float width)    { _blendTop    = _clampBlend(width); }
+  void setBlendBottom(float width) { _blendBottom = _clampBlend(width); }
+  void setBlendGamma(float gamma)  { _blendGamma  = qMax(gamma, 0.01f); }
+
+  /// Returns true iff warp is not the identity.
+  bool hasWarp() const;
+
+  /// Returns true iff at least one edge is blended.
+  bool hasBlend() const;
+
+  /// Returns true iff the correction leaves the output unchanged.
+  bool isIdentity() const { return !hasWarp() && !hasBlend(); }
+
+  virtual void read(const QDomElement& obj);
+  virtual void write(QDomElement& obj);
+
+private:
+  static float _clampBlend(float width) { return qBound(0.0f, width, 0.5f); }
+
+  int _warpColumns;
+  int _warpRows;
+  QVector<QPointF> _warpPoints;
+
+  float _blendLeft;
+  float _blendRight;
+  float _blendTop;
+  float _blendBottom;
+  float _blendGamma;
+};
+
+}
+
+#endif /* OUTPUT_CORRECTION_H_ */
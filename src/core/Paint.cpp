@@ -37,6 +37,17 @@ void Texture::update()
   }
 }
 
+quint64 Texture::getGeometryVersion() const
+{
+  QRectF rect = getRect();
+  if (rect != _versionedRect)
+  {
+    _versionedRect = rect;
+    _geometryVersion++;
+  }
+  return _geometryVersion;
+}
+
 void Texture::read(const QDomElement& obj)
 {
   Paint::read(obj);
@@ -158,6 +169,7 @@ void Image::rewind()
 }
 
 const uchar* Image::getBits() {
+  bitsChanged = false;
   return _bits;
 }
 
@@ -75,6 +75,9 @@ public:
   /// This method should be called at each call of draw().
   virtual void update() {}
 
+  /// Returns true iff the paint content changes by itself and needs to be redrawn (eg. new video frame).
+  virtual bool needsRedraw() const { return false; }
+
   /// Is the paint currently playing?
   virtual bool isPlaying() const { return _isPlaying; }
 
@@ -156,7 +159,9 @@ protected:
     Paint(id),
     textureId(0),
     x(0),
-    y(0)
+    y(0),
+    bitsChanged(false),
+    _geometryVersion(0)
   {
   }
 
@@ -181,6 +186,8 @@ public:
   /// Returns true iff bits have changed since last call to getBits().
   virtual bool bitsHaveChanged() const = 0;
 
+  virtual bool needsRedraw() const { return bitsHaveChanged(); }
+
   virtual GLfloat getX() const { return x; }
   virtual GLfloat getY() const { return y; }
 
@@ -199,12 +206,24 @@ public:
 
   virtual QRectF getRect() const { return QRectF(getX(), getY(), getWidth(), getHeight()); }
 
+  /**
+   * Returns the geometry version of the texture: it changes whenever getRect() does,
+   * so that caches of texture coordinates can check their validity in constant time.
+   * The size is not always under our control (eg. video streams) so it is checked here.
+   */
+  quint64 getGeometryVersion() const;
+
   virtual void read(const QDomElement& obj);
   virtual void write(QDomElement& obj);
 
 protected:
   // Lists QProperties that should NOT be parsed automatically.
   virtual QList<QString> _propertiesSpecial() const { return Paint::_propertiesSpecial() << "x" << "y"; }
+
+private:
+  // Rectangle when the geometry version was last changed.
+  mutable QRectF _versionedRect;
+  mutable quint64 _geometryVersion;
 };
 
 /**
@@ -257,6 +276,9 @@ public:
 
   virtual bool bitsHaveChanged() const { return bitsChanged; }
 
+  // Animations need to be redrawn for update() to move to the next frame.
+  virtual bool needsRedraw() const { return bitsHaveChanged() || (isAnimation() && isPlaying()); }
+
   virtual QIcon getIcon() const
   {
     return QIcon(QPixmap::fromImage(_images[0]).scaled(MM::MAPPING_LIST_ICON_SIZE, MM::MAPPING_LIST_ICON_SIZE,
@@ -325,6 +347,9 @@ public:
 
   virtual bool bitsHaveChanged() const;
 
+  // Playing videos need update() to be called to check for end of stream.
+  virtual bool needsRedraw() const { return bitsHaveChanged() || isPlaying(); }
+
   /// Sets playback rate (in %). Negative values mean reverse playback.
   virtual void setRate(double rate);
 
@@ -24,6 +24,9 @@ namespace mmp {
 const char* ProjectLabels::CLASS_NAME  = "className";
 const char* ProjectLabels::PAINTS      = "paints";
 const char* ProjectLabels::MAPPINGS    = "mappings";
+const char* ProjectLabels::OUTPUTS     = "outputs";
+const char* ProjectLabels::OUTPUT      = "output";
+const char* ProjectLabels::INDEX       = "index";
 const char* ProjectLabels::ID          = "id";
 const char* ProjectLabels::PAINT_ID    = "paintId";
 const char* ProjectLabels::NAME        = "name";
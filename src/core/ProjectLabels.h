@@ -29,6 +29,9 @@ public:
   static const char* CLASS_NAME;
   static const char* PAINTS;
   static const char* MAPPINGS;
+  static const char* OUTPUTS;
+  static const char* OUTPUT;
+  static const char* INDEX;
 
   static const char* ID;
   static const char* NAME;
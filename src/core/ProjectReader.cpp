@@ -85,7 +85,8 @@ void ProjectReader::parseProject(const QDomElement& project)
   QDomElement paints = project.firstChildElement(ProjectLabels::PAINTS);
   QDomElement mappings = project.firstChildElement(ProjectLabels::MAPPINGS);
 
-  // Parse paints.
+  // Parse paints (items are added all at once).
+  QVector<uid> paintIds;
   QDomNode paintNode = paints.firstChild();
   while (!paintNode.isNull())
   {
@@ -97,13 +98,15 @@ void ProjectReader::parseProject(const QDomElement& project)
     }
     else
     {
-      manager.addPaint(paint);
-      _window->addPaintItem(paint->getId(), paint->getIcon(), paint->getName());
+      paintIds.push_back(manager.addPaint(paint));
     }
     paintNode = paintNode.nextSibling();
   }
 
-  // Parse mappings.
+  _window->addPaintItems(paintIds);
+
+  // Parse mappings (added all at once).
+  QVector<Mapping::ptr> parsedMappings;
   QDomNode mappingNode = mappings.firstChild();
   while (!mappingNode.isNull())
   {
@@ -113,13 +116,25 @@ void ProjectReader::parseProject(const QDomElement& project)
       qDebug() << "Problem creating mapping." << endl;
     }
     else
-    {
-      manager.addMapping(mapping);
-      _window->addMappingItem(mapping->getId());
-    }
+      parsedMappings.push_back(mapping);
 
     mappingNode = mappingNode.nextSibling();
   }
+
+  _window->addMappingItems(manager.addMappings(parsedMappings));
+
+  // Parse output corrections.
+  _window->clearOutputCorrections();
+  QDomElement outputs = project.firstChildElement(ProjectLabels::OUTPUTS);
+  QDomElement outputElem = outputs.firstChildElement(ProjectLabels::OUTPUT);
+  while (!outputElem.isNull())
+  {
+    OutputCorrection::ptr correction(new OutputCorrection);
+    correction->read(outputElem);
+    _window->setOutputCorrection(outputElem.attribute(ProjectLabels::INDEX, "0").toInt(), correction);
+
+    outputElem = outputElem.nextSiblingElement(ProjectLabels::OUTPUT);
+  }
 }
 
 Paint::ptr ProjectReader::parsePaint(const QDomElement& paintElem)
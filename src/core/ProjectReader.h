@@ -23,6 +23,7 @@
 #include "MainWindow.h"
 #include "Mapping.h"
 #include "Paint.h"
+#include "OutputCorrection.h"
 
 #include "MetaObjectRegistry.h"
 #include "ProjectLabels.h"
@@ -53,8 +53,23 @@ bool ProjectWriter::writeFile(QIODevice *device)
     mappings.appendChild(mapping);
   }
 
+  // Output corrections (warp and edge blend of each output).
+  QDomElement outputs = doc.createElement(ProjectLabels::OUTPUTS);
+  for (int i=0; i<_window->nOutputCorrections(); i++)
+  {
+    OutputCorrection::ptr correction = _window->getOutputCorrection(i);
+    if (correction->isIdentity())
+      continue;
+
+    QDomElement output = doc.createElement(ProjectLabels::OUTPUT);
+    output.setAttribute(ProjectLabels::INDEX, i);
+    correction->write(output);
+    outputs.appendChild(output);
+  }
+
   project.appendChild(paints);
   project.appendChild(mappings);
+  project.appendChild(outputs);
   doc.appendChild(project);
 
   QTextStream out(device);
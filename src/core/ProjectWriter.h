@@ -24,6 +24,7 @@
 #include "MappingManager.h"
 #include "Mapping.h"
 #include "Paint.h"
+#include "OutputCorrection.h"
 #include "MainWindow.h"
 
 #include "ProjectLabels.h"
@@ -0,0 +1,46 @@
+/*
+ * SharedMemoryOutput.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedMemoryOutput.h"
+
+#include <gst/gst.h>
+
+namespace mmp {
+
+QString SharedMemoryOutput::_sinkDescription() const
+{
+  // Never wait for consumers nor for the clock.
+  return "gdppay ! shmsink name=shmsink wait-for-connection=false sync=false";
+}
+
+void SharedMemoryOutput::_configurePipeline(GstElement* pipeline, const QSize& size)
+{
+  GstElement* shmsink = gst_bin_get_by_name(GST_BIN(pipeline), "shmsink");
+
+  // Room for a bounded number of frames (plus payload headers).
+  guint frameSize = size.width() * size.height() * 4 + 1024;
+  g_object_set(shmsink,
+               "socket-path", _socketPath.toUtf8().constData(),
+               "shm-size", frameSize * MM::FRAME_OUTPUT_MAX_QUEUED_FRAMES,
+               NULL);
+
+  gst_object_unref(shmsink);
+}
+
+}
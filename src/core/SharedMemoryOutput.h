@@ -0,0 +1,62 @@
+/*
+ * SharedMemoryOutput.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_MEMORY_OUTPUT_H_
+#define SHARED_MEMORY_OUTPUT_H_
+
+#include "FrameOutput.h"
+#include "MM.h"
+
+namespace mmp {
+
+/**
+ * Publishes the composed frames into a shared memory area through GStreamer's
+ * shmsink, so that other processes on the same host can use them without screen
+ * capture. Frames are GDP-payloaded (caps travel with the stream), which is the
+ * format read by MapMap's own shared memory sources. Consumers can use eg.
+ *
+ *   gst-launch-1.0 shmsrc socket-path=/tmp/mapmap-output is-live=true ! gdpdepay ! videoconvert ! autovideosink
+ *
+ * Frames are raw top-down BGRA. When their size changes the pipeline is rebuilt: new
+ * caps travel with the stream so consumers follow. The shared memory holds at most
+ * MM::FRAME_OUTPUT_MAX_QUEUED_FRAMES frames, which bounds latency: when consumers
+ * fall behind, new frames are dropped rather than queued.
+ */
+class SharedMemoryOutput : public FrameOutput
+{
+public:
+  SharedMemoryOutput() : _socketPath(MM::DEFAULT_SHARED_MEMORY_OUTPUT_PATH) {}
+  virtual ~SharedMemoryOutput() { stop(); }
+
+  /// Sets the path of the control socket consumers connect to (applies on next start()).
+  void setSocketPath(const QString& path) { _socketPath = path; }
+  const QString& getSocketPath() const { return _socketPath; }
+
+protected:
+  virtual QString _sinkDescription() const;
+  virtual void _configurePipeline(GstElement* pipeline, const QSize& size);
+  virtual bool _supportsSizeChanges() const { return true; }
+
+private:
+  QString _socketPath;
+};
+
+}
+
+#endif /* SHARED_MEMORY_OUTPUT_H_ */
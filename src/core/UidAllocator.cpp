@@ -19,52 +19,91 @@
  */
 
 #include "UidAllocator.h"
-#include <algorithm> // std::find
-#include <iostream>
-#include <sstream>
+
+#include <algorithm>
 
 namespace mmp {
 
 uid UidAllocator::allocate()
 {
-  // Iterate until we find an id that has not been taken.
-  uid id = 1;
-  while (exists(id))
-    id++;
+  // Reuse a released id if there is one.
+  while (!_freeIds.empty())
+  {
+    uid id = _freeIds.back();
+    _freeIds.pop_back();
+    if (!exists(id))
+    {
+      _take(id);
+      return id;
+    }
+  }
 
-  // Add id to the list.
-  _ids.push_back(id);
+  // Otherwise take the next id that was never allocated (skipping reserved ones).
+  while (exists(_nextId))
+    _nextId++;
 
-  // Return it.
+  uid id = _nextId++;
+  _take(id);
   return id;
 }
 
 bool UidAllocator::reserve(uid id)
 {
-  if (exists(id))
+  if (id <= NULL_UID || exists(id))
     return false;
   else
   {
-    _ids.push_back(id);
+    _take(id);
     return true;
   }
 }
 
 bool UidAllocator::free(uid id)
 {
-  std::vector<uid>::iterator it = std::find(_ids.begin(), _ids.end(), id);
-  if (it != _ids.end())
+  if (exists(id))
   {
-    _ids.erase(it);
+    if (id < MM::UID_ALLOCATOR_MAX_BITMAP_SIZE)
+      _taken[id] = false;
+    else
+      _largeIds.remove(id);
+    _nIds--;
+
+    // Ids above _nextId will be found by allocate() anyway.
+    if (id < _nextId)
+      _freeIds.push_back(id);
     return true;
   }
   else
     return false;
 }
 
-bool UidAllocator::exists(uid id) const
+std::vector<uid> UidAllocator::list() const
 {
-  return ( std::find(_ids.begin(), _ids.end(), id) != _ids.end() );
+  std::vector<uid> ids;
+  ids.reserve(_nIds);
+  for (uid id = 1; id < (uid)_taken.size(); id++)
+    if (_taken[id])
+      ids.push_back(id);
+
+  // Large ids come after all others.
+  size_t nSmallIds = ids.size();
+  foreach (uid id, _largeIds)
+    ids.push_back(id);
+  std::sort(ids.begin() + nSmallIds, ids.end());
+  return ids;
+}
+
+void UidAllocator::_take(uid id)
+{
+  if (id < MM::UID_ALLOCATOR_MAX_BITMAP_SIZE)
+  {
+    if (id >= (uid)_taken.size())
+      _taken.resize(qMin(qMax((size_t)id + 1, 2*_taken.size()), (size_t)MM::UID_ALLOCATOR_MAX_BITMAP_SIZE), false);
+    _taken[id] = true;
+  }
+  else
+    _largeIds.insert(id);
+  _nIds++;
 }
 
 }
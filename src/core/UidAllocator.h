@@ -28,6 +28,7 @@
 
 #include <string>
 #include <vector>
+#include <QSet>
 #include "MM.h"
 
 /// A UID in Libremapping is represented as a integer.
@@ -41,18 +42,60 @@ namespace mmp {
 /**
  * Allocates uids for instances by appending an incremental number to a given string.
  * Manages a pool of unique names.
+ *
+ * Allocation, reservation, release and lookup all run in (amortized) constant time:
+ * taken ids are kept in a bitmap indexed by id, and released ids are recycled from
+ * a free list before new ids are handed out. The bitmap only covers ids below
+ * MM::UID_ALLOCATOR_MAX_BITMAP_SIZE: larger ids (eg. reserved from a project file)
+ * are kept in a set so that they do not cost memory proportional to their value.
  */
 class UidAllocator
 {
 public:
+  UidAllocator() : _nextId(1), _nIds(0) {}
+
+  /// Returns a new id (released ids are reused first).
   uid allocate();
+
+  /// Releases id. Returns false if id was not taken (eg. if it was already released).
   bool free(uid id);
+
+  /// Takes given id. Returns false if id is invalid or already taken.
   bool reserve(uid id);
-  bool exists(uid id) const;
-  std::vector<uid> list() const { return _ids; }
+
+  /// Returns true iff id is currently taken.
+  bool exists(uid id) const
+  {
+    return (id < MM::UID_ALLOCATOR_MAX_BITMAP_SIZE ?
+            (id > 0 && id < (uid)_taken.size() && _taken[id]) :
+            _largeIds.contains(id));
+  }
+
+  /// Returns the number of ids currently taken.
+  int size() const { return _nIds; }
+
+  /// Returns all ids currently taken, in increasing order.
+  std::vector<uid> list() const;
 
 private:
-  std::vector<uid> _ids;
+  // Marks id as taken, growing bitmap if needed.
+  void _take(uid id);
+
+  // Bitmap of taken ids (below MM::UID_ALLOCATOR_MAX_BITMAP_SIZE).
+  std::vector<bool> _taken;
+
+  // Taken ids too large for the bitmap.
+  QSet<uid> _largeIds;
+
+  // Released ids below _nextId. May contain ids that were reserved again since
+  // (these are skipped lazily by allocate()).
+  std::vector<uid> _freeIds;
+
+  // All ids below this one were either allocated or are in _freeIds.
+  uid _nextId;
+
+  // Number of taken ids.
+  int _nIds;
 };
 
 }
@@ -77,6 +77,101 @@ int map_int(int value, int istart, int istop, int ostart, int ostop)
     return std::max(std::min(int(ret), ostop), ostart);
 }
 
+// Returns twice the signed area of polygon.
+static qreal _signedArea2(const QPolygonF& polygon)
+{
+  qreal area = 0;
+  for (int i=0, j=polygon.size()-1; i<polygon.size(); j=i++)
+    area += polygon[j].x()*polygon[i].y() - polygon[i].x()*polygon[j].y();
+  return area;
+}
+
+// Returns the cross product of (b-a) and (c-a).
+static qreal _cross(const QPointF& a, const QPointF& b, const QPointF& c)
+{
+  return (b.x()-a.x())*(c.y()-a.y()) - (b.y()-a.y())*(c.x()-a.x());
+}
+
+// Returns true iff vertices u, v, w (indices in indices) form an ear of the positively oriented polygon.
+static bool _isEar(const QPolygonF& polygon, const QVector<int>& indices, int u, int v, int w)
+{
+  const QPointF& a = polygon[indices[u]];
+  const QPointF& b = polygon[indices[v]];
+  const QPointF& c = polygon[indices[w]];
+
+  // Must be convex.
+  if (_cross(a, b, c) <= 1e-10)
+    return false;
+
+  // No other vertex may lie inside.
+  for (int i=0; i<indices.size(); i++)
+  {
+    if (i == u || i == v || i == w)
+      continue;
+    const QPointF& p = polygon[indices[i]];
+    if (_cross(a, b, p) >= 0 && _cross(b, c, p) >= 0 && _cross(c, a, p) >= 0)
+      return false;
+  }
+  return true;
+}
+
+bool triangulate(const QPolygonF& polygon, QVector<QPointF>& triangles)
+{
+  QPolygonF poly = polygon;
+  if (poly.size() > 1 && poly.isClosed())
+    poly.removeLast();
+
+  int n = poly.size();
+  if (n < 3)
+    return false;
+
+  // Work on positively oriented indices.
+  QVector<int> indices(n);
+  bool positive = (_signedArea2(poly) > 0);
+  for (int i=0; i<n; i++)
+    indices[i] = (positive ? i : n-1-i);
+
+  // Clip one ear at a time; give up after a full loop without finding any.
+  int v = n-1;
+  int nTries = 2*n;
+  while (indices.size() > 2)
+  {
+    int nv = indices.size();
+    if (nTries-- <= 0)
+    {
+      // Degenerate (eg. self-intersecting) polygon: finish as a fan.
+      for (int i=2; i<nv; i++)
+      {
+        triangles.append(poly[indices[0]]);
+        triangles.append(poly[indices[i-1]]);
+        triangles.append(poly[indices[i]]);
+      }
+      return false;
+    }
+
+    int u = (v < nv ? v : 0);
+    v = (u+1 < nv ? u+1 : 0);
+    int w = (v+1 < nv ? v+1 : 0);
+
+    if (_isEar(poly, indices, u, v, w))
+    {
+      triangles.append(poly[indices[u]]);
+      triangles.append(poly[indices[v]]);
+      triangles.append(poly[indices[w]]);
+      indices.remove(v);
+      nTries = 2*indices.size();
+    }
+  }
+
+  return true;
+}
+
+bool quadSplitsAlongAC(const QPointF& a, const QPointF& b, const QPointF& c, const QPointF& d)
+{
+  // Diagonal is inside iff b and d lie on opposite sides of it.
+  return (_cross(a, c, b) * _cross(a, c, d) <= 0);
+}
+
 Mesh* createMeshForTexture(Texture* texture, int frameWidth, int frameHeight)
 {
   Q_UNUSED(frameHeight);
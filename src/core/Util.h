@@ -59,6 +59,19 @@ float map_float(float value, float istart, float istop, float ostart, float osto
  */
 int map_int(int value, int istart, int istop, int ostart, int ostop);
 
+/**
+ * Triangulates a simple (possibly concave) polygon using ear clipping and appends
+ * the triangles (three points each) to triangles. Returns false if polygon is
+ * degenerate (in which case the remaining part is triangulated as a fan).
+ */
+bool triangulate(const QPolygonF& polygon, QVector<QPointF>& triangles);
+
+/**
+ * Returns true iff quad abcd (possibly concave) can be split along its a-c diagonal,
+ * ie. into triangles abc and acd. Otherwise it must be split into abd and bcd.
+ */
+bool quadSplitsAlongAC(const QPointF& a, const QPointF& b, const QPointF& c, const QPointF& d);
+
 // FIXME: these texture/color/drawing utilities should be moved to another file
 Mesh* createMeshForTexture(Texture* texture, int frameWidth, int frameHeight);
 Triangle* createTriangleForTexture(Texture* texture, int frameWidth, int frameHeight);
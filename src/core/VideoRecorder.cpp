@@ -0,0 +1,42 @@
+/*
+ * VideoRecorder.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VideoRecorder.h"
+
+#include <gst/gst.h>
+
+namespace mmp {
+
+QString VideoRecorder::_sinkDescription() const
+{
+  // Fastest encoder settings: recording must not compete with rendering.
+  return "x264enc tune=zerolatency speed-preset=ultrafast ! mp4mux ! filesink name=filesink";
+}
+
+void VideoRecorder::_configurePipeline(GstElement* pipeline, const QSize& size)
+{
+  Q_UNUSED(size);
+
+  // Set location here rather than in the description (no need to escape the path).
+  GstElement* filesink = gst_bin_get_by_name(GST_BIN(pipeline), "filesink");
+  g_object_set(filesink, "location", _filename.toUtf8().constData(), NULL);
+  gst_object_unref(filesink);
+}
+
+}
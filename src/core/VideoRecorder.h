@@ -0,0 +1,50 @@
+/*
+ * VideoRecorder.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIDEO_RECORDER_H_
+#define VIDEO_RECORDER_H_
+
+#include "FrameOutput.h"
+
+namespace mmp {
+
+/**
+ * Records the composed frames into an H.264 video file (MP4 container).
+ */
+class VideoRecorder : public FrameOutput
+{
+public:
+  VideoRecorder() {}
+  virtual ~VideoRecorder() { stop(); }
+
+  /// Sets the file to record to (applies on next start()).
+  void setFilename(const QString& filename) { _filename = filename; }
+  const QString& getFilename() const { return _filename; }
+
+protected:
+  virtual QString _sinkDescription() const;
+  virtual void _configurePipeline(GstElement* pipeline, const QSize& size);
+
+private:
+  QString _filename;
+};
+
+}
+
+#endif /* VIDEO_RECORDER_H_ */
@@ -3,18 +3,23 @@ include(../src.pri)
 
 HEADERS += $$PWD/Commands.h \
     $$PWD/Element.h \
+    $$PWD/FrameOutput.h \
     $$PWD/Mapping.h \
     $$PWD/MappingManager.h \
     $$PWD/Maths.h \
     $$PWD/MetaObjectRegistry.h \
     $$PWD/MM.h \
+    $$PWD/NameIndex.h \
+    $$PWD/OutputCorrection.h \
     $$PWD/Paint.h \
     $$PWD/ProjectLabels.h \
     $$PWD/ProjectReader.h \
     $$PWD/ProjectWriter.h \
     $$PWD/Serializable.h \
+    $$PWD/SharedMemoryOutput.h \
     $$PWD/UidAllocator.h \
     $$PWD/VideoImpl.h \
+    $$PWD/VideoRecorder.h \
     $$PWD/VideoShmSrcImpl.h \
     $$PWD/VideoUriDecodeBinImpl.h \
     $$PWD/VideoV4l2SrcImpl.h \
@@ -22,17 +27,21 @@ HEADERS += $$PWD/Commands.h \
 
 SOURCES += $$PWD/Commands.cpp \
     $$PWD/Element.cpp \
+    $$PWD/FrameOutput.cpp \
     $$PWD/Mapping.cpp \
     $$PWD/MappingManager.cpp \
     $$PWD/MetaObjectRegistry.cpp \
     $$PWD/MM.cpp \
+    $$PWD/OutputCorrection.cpp \
     $$PWD/Paint.cpp \
     $$PWD/ProjectLabels.cpp \
     $$PWD/ProjectReader.cpp \
     $$PWD/ProjectWriter.cpp \
     $$PWD/Serializable.cpp \
+    $$PWD/SharedMemoryOutput.cpp \
     $$PWD/UidAllocator.cpp \
     $$PWD/VideoImpl.cpp \
+    $$PWD/VideoRecorder.cpp \
     $$PWD/VideoShmSrcImpl.cpp \
     $$PWD/VideoUriDecodeBinImpl.cpp \
     $$PWD/VideoV4l2SrcImpl.cpp \
@@ -0,0 +1,280 @@
+/*
+ * BatchRenderer.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchRenderer.h"
+
+#include "ShapeGraphicsItem.h"
+#include "Util.h"
+
+namespace mmp {
+
+TextureBatch::TextureBatch()
+{
+  setColor(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void TextureBatch::setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+  _color[0] = r;
+  _color[1] = g;
+  _color[2] = b;
+  _color[3] = a;
+}
+
+void TextureBatch::addVertex(const Texture& texture, const QPointF& inputPoint, const QPointF& outputPoint)
+{
+  // Same computation as Util::setGlTexPoint().
+  _texCoords.append((inputPoint.x() - texture.getX()) / (GLfloat) texture.getWidth());
+  _texCoords.append((inputPoint.y() - texture.getY()) / (GLfloat) texture.getHeight());
+
+  _vertices.append(outputPoint.x());
+  _vertices.append(outputPoint.y());
+
+  for (int i=0; i<4; i++)
+    _colors.append(_color[i]);
+}
+
+void TextureBatch::addTriangle(const Texture& texture,
+                               const QPointF& inputA, const QPointF& inputB, const QPointF& inputC,
+                               const QPointF& outputA, const QPointF& outputB, const QPointF& outputC)
+{
+  addVertex(texture, inputA, outputA);
+  addVertex(texture, inputB, outputB);
+  addVertex(texture, inputC, outputC);
+}
+
+void TextureBatch::addQuad(const Texture& texture, const QPointF input[4], const QPointF output[4])
+{
+  // Split along the diagonal that stays inside the (possibly concave) output quad.
+  if (Util::quadSplitsAlongAC(output[0], output[1], output[2], output[3]))
+  {
+    addTriangle(texture, input[0], input[1], input[2], output[0], output[1], output[2]);
+    addTriangle(texture, input[0], input[2], input[3], output[0], output[2], output[3]);
+  }
+  else
+  {
+    addTriangle(texture, input[0], input[1], input[3], output[0], output[1], output[3]);
+    addTriangle(texture, input[1], input[2], input[3], output[1], output[2], output[3]);
+  }
+}
+
+void TextureBatch::append(const TextureBatch& other)
+{
+  _vertices  += other._vertices;
+  _texCoords += other._texCoords;
+
+  int n = other.nVertices();
+  _colors.reserve(_colors.size() + 4*n);
+  for (int v=0; v<n; v++)
+    for (int i=0; i<4; i++)
+      _colors.append(_color[i]);
+}
+
+void TextureBatch::draw() const
+{
+  if (isEmpty())
+    return;
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+
+  glVertexPointer(2, GL_FLOAT, 0, _vertices.constData());
+  glTexCoordPointer(2, GL_FLOAT, 0, _texCoords.constData());
+  glColorPointer(4, GL_FLOAT, 0, _colors.constData());
+
+  glDrawArrays(GL_TRIANGLES, 0, nVertices());
+
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void TextureBatch::clear()
+{
+  // Keep allocated memory for next frame.
+  _vertices.resize(0);
+  _texCoords.resize(0);
+  _colors.resize(0);
+}
+
+ColorBatch::ColorBatch()
+{
+  setColor(Qt::white);
+}
+
+void ColorBatch::setColor(const QColor& color)
+{
+  _color[0] = color.redF();
+  _color[1] = color.greenF();
+  _color[2] = color.blueF();
+  _color[3] = color.alphaF();
+}
+
+void ColorBatch::addVertex(const QPointF& point, GLfloat coverage)
+{
+  _vertices.append(point.x());
+  _vertices.append(point.y());
+
+  for (int i=0; i<3; i++)
+    _colors.append(_color[i]);
+  _colors.append(_color[3] * coverage);
+}
+
+void ColorBatch::addTriangle(const QPointF& a, const QPointF& b, const QPointF& c)
+{
+  addVertex(a);
+  addVertex(b);
+  addVertex(c);
+}
+
+void ColorBatch::addQuad(const QPointF& a, const QPointF& b, const QPointF& c, const QPointF& d)
+{
+  // Split along the diagonal that stays inside the (possibly concave) quad.
+  if (Util::quadSplitsAlongAC(a, b, c, d))
+  {
+    addTriangle(a, b, c);
+    addTriangle(a, c, d);
+  }
+  else
+  {
+    addTriangle(a, b, d);
+    addTriangle(b, c, d);
+  }
+}
+
+void ColorBatch::draw() const
+{
+  if (isEmpty())
+    return;
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+
+  glVertexPointer(2, GL_FLOAT, 0, _vertices.constData());
+  glColorPointer(4, GL_FLOAT, 0, _colors.constData());
+
+  glDrawArrays(GL_TRIANGLES, 0, nVertices());
+
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void ColorBatch::clear()
+{
+  // Keep allocated memory for next frame.
+  _vertices.resize(0);
+  _colors.resize(0);
+}
+
+BatchRenderer::BatchRenderer(QPainter* painter, QWidget* widget)
+  : _painter(painter), _widget(widget)
+{
+  Q_CHECK_PTR(painter);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+  flush();
+}
+
+void BatchRenderer::drawItem(QGraphicsItem* item, const QStyleOptionGraphicsItem* option)
+{
+  if (!item->isVisible())
+    return;
+
+  // Only output items with no transform can be batched (their geometry is then
+  // expressed in the same coordinates as the painter's).
+  ShapeGraphicsItem* shapeItem = dynamic_cast<ShapeGraphicsItem*>(item);
+  bool batchable = (shapeItem && shapeItem->isOutput() && item->sceneTransform().isIdentity());
+
+  TextureGraphicsItem* textureItem = (batchable ? dynamic_cast<TextureGraphicsItem*>(item) : 0);
+  ColorGraphicsItem*   colorItem   = (batchable ? dynamic_cast<ColorGraphicsItem*>(item)   : 0);
+  if (textureItem)
+  {
+    if (!textureItem->prepareToPaint())
+      return;
+
+    // Start a new batch when the texture changes.
+    QSharedPointer<Texture> texture = textureItem->getTexture();
+    if (texture != _texture || !_colorBatch.isEmpty())
+    {
+      flush();
+      _texture = texture;
+    }
+
+    textureItem->appendGeometry(_batch);
+  }
+  else if (colorItem)
+  {
+    if (!colorItem->prepareToPaint())
+      return;
+
+    // Color items of any color share a batch.
+    if (!_batch.isEmpty())
+      flush();
+
+    colorItem->appendGeometry(_colorBatch);
+  }
+  else
+  {
+    flush();
+
+    _painter->save();
+    _painter->setTransform(item->sceneTransform(), true);
+    item->paint(_painter, option, _widget);
+    _painter->restore();
+  }
+}
+
+void BatchRenderer::flush()
+{
+  if (!_batch.isEmpty())
+  {
+    _painter->beginNativePainting();
+    TextureGraphicsItem::bindTexture(_texture);
+    _batch.draw();
+    glDisable(GL_TEXTURE_2D);
+    _painter->endNativePainting();
+
+    _batch.clear();
+  }
+  _texture.clear();
+
+  if (!_colorBatch.isEmpty())
+  {
+    _painter->beginNativePainting();
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    _colorBatch.draw();
+    _painter->endNativePainting();
+
+    _colorBatch.clear();
+  }
+}
+
+void BatchRenderer::drawItems(QPainter* painter, int numItems, QGraphicsItem* items[],
+                              const QStyleOptionGraphicsItem options[], QWidget* widget)
+{
+  BatchRenderer renderer(painter, widget);
+  for (int i=0; i<numItems; i++)
+    renderer.drawItem(items[i], &options[i]);
+}
+
+}
@@ -0,0 +1,160 @@
+/*
+ * BatchRenderer.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_RENDERER_H_
+#define BATCH_RENDERER_H_
+
+#include <QtGlobal>
+
+#if __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <QColor>
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+
+#include "Paint.h"
+
+namespace mmp {
+
+/**
+ * Client-side vertex arrays of textured, colored triangles that are submitted to GL
+ * in a single draw call.
+ */
+class TextureBatch
+{
+public:
+  TextureBatch();
+
+  /// Sets the color (incl. opacity) of the vertices added from now on.
+  void setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+  /// Adds a vertex: inputPoint is in texture space, outputPoint in painter coordinates.
+  void addVertex(const Texture& texture, const QPointF& inputPoint, const QPointF& outputPoint);
+
+  /// Adds a triangle.
+  void addTriangle(const Texture& texture,
+                   const QPointF& inputA, const QPointF& inputB, const QPointF& inputC,
+                   const QPointF& outputA, const QPointF& outputB, const QPointF& outputC);
+
+  /// Adds a quad (vertices in order) as two triangles.
+  void addQuad(const Texture& texture, const QPointF input[4], const QPointF output[4]);
+
+  /// Adds all triangles of other batch, using the current color of this batch.
+  void append(const TextureBatch& other);
+
+  /// Draws all triangles (texture and blending must already be set up).
+  void draw() const;
+
+  /// Removes all vertices.
+  void clear();
+
+  /// Returns the number of vertices.
+  int nVertices() const { return _vertices.size() / 2; }
+
+  bool isEmpty() const { return _vertices.isEmpty(); }
+
+private:
+  QVector<GLfloat> _vertices;
+  QVector<GLfloat> _texCoords;
+  QVector<GLfloat> _colors;
+  GLfloat _color[4];
+};
+
+/**
+ * Client-side vertex arrays of flat-colored triangles that are submitted to GL in a
+ * single draw call.
+ */
+class ColorBatch
+{
+public:
+  ColorBatch();
+
+  /// Sets the color (incl. opacity) of the vertices added from now on.
+  void setColor(const QColor& color);
+
+  /// Adds a vertex (in painter coordinates); coverage multiplies the opacity.
+  void addVertex(const QPointF& point, GLfloat coverage = 1.0f);
+
+  /// Adds a triangle.
+  void addTriangle(const QPointF& a, const QPointF& b, const QPointF& c);
+
+  /// Adds a quad (vertices in order) as two triangles.
+  void addQuad(const QPointF& a, const QPointF& b, const QPointF& c, const QPointF& d);
+
+  /// Draws all triangles (texturing must be disabled and blending set up).
+  void draw() const;
+
+  /// Removes all vertices.
+  void clear();
+
+  /// Returns the number of vertices.
+  int nVertices() const { return _vertices.size() / 2; }
+
+  bool isEmpty() const { return _vertices.isEmpty(); }
+
+private:
+  QVector<GLfloat> _vertices;
+  QVector<GLfloat> _colors;
+  GLfloat _color[4];
+};
+
+/**
+ * Paints graphics items in stacking order, grouping consecutive output texture items that
+ * share the same texture into a single batch: the texture is then bound and its parameters
+ * set only once and all their triangles are submitted with one draw call. Consecutive color
+ * items are batched the same way. Other items are painted normally (and break the current
+ * batch so that stacking order is preserved).
+ */
+class BatchRenderer
+{
+public:
+  BatchRenderer(QPainter* painter, QWidget* widget = 0);
+  ~BatchRenderer();
+
+  /// Paints item (must be called in ascending stacking order).
+  void drawItem(QGraphicsItem* item, const QStyleOptionGraphicsItem* option);
+
+  /// Submits the current batch (if any).
+  void flush();
+
+  /// Paints items (in ascending stacking order).
+  static void drawItems(QPainter* painter, int numItems, QGraphicsItem* items[],
+                        const QStyleOptionGraphicsItem options[], QWidget* widget = 0);
+
+private:
+  QPainter* _painter;
+  QWidget* _widget;
+
+  // Texture of the current batch.
+  QSharedPointer<Texture> _texture;
+  TextureBatch _batch;
+
+  // Batch of consecutive color items.
+  ColorBatch _colorBatch;
+};
+
+}
+
+#endif /* BATCH_RENDERER_H_ */
@@ -0,0 +1,200 @@
+/*
+ * Compositor.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compositor.h"
+
+#include "BatchRenderer.h"
+#include "MainWindow.h"
+#include "MM.h"
+
+namespace mmp {
+
+Compositor::Compositor(const QGLWidget* shareWidget)
+  : _shareWidget(const_cast<QGLWidget*>(shareWidget)),
+    _renderFbo(NULL),
+    _textureFbo(NULL),
+    _nativeRendering(false),
+    _renderScale(MM::DEFAULT_RENDER_SCALE),
+    _hasMipmaps(false),
+    _hasFrame(false)
+{
+  Q_CHECK_PTR(_shareWidget);
+}
+
+Compositor::~Compositor()
+{
+  release();
+}
+
+void Compositor::render(QGraphicsScene* scene, const QRectF& sceneRect, const QSize& outputSize)
+{
+  // Internal resolution.
+  QSize size = (QSizeF(outputSize) * _renderScale).toSize();
+  if (size.isEmpty())
+  {
+    release();
+    return;
+  }
+
+  _shareWidget->makeCurrent();
+
+  // (Re)allocate framebuffers if internal resolution changed.
+  if (size != _size || !_renderFbo)
+    _allocate(size);
+
+  _sceneRect = sceneRect;
+
+  // Render scene (same hints as the canvases).
+  {
+    QPainter painter(_renderFbo);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing |
+                           QPainter::HighQualityAntialiasing | QPainter::SmoothPixmapTransform);
+    painter.fillRect(QRect(QPoint(0, 0), size), scene->backgroundBrush());
+
+    // Map scene region to framebuffer.
+    QTransform transform = QTransform::fromScale(size.width()  / sceneRect.width(),
+                                                 size.height() / sceneRect.height());
+    transform.translate(-sceneRect.x(), -sceneRect.y());
+    painter.setTransform(transform);
+
+    if (_nativeRendering)
+    {
+      _nativeRenderer.render(&painter, MainWindow::window()->getMappingManager());
+    }
+    else
+    {
+      // Paint items ourselves (rather than through QGraphicsScene::render()) so that
+      // mappings sharing a texture are batched together.
+      QStyleOptionGraphicsItem option;
+      option.exposedRect = sceneRect;
+
+      QList<QGraphicsItem*> items = scene->items(sceneRect, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder);
+      BatchRenderer renderer(&painter);
+      for (QGraphicsItem* item: items)
+        renderer.drawItem(item, &option);
+      renderer.flush();
+    }
+  }
+
+  // Resolve multisampled framebuffer into texture.
+  if (_textureFbo != _renderFbo)
+  {
+    QRect rect(QPoint(0, 0), size);
+    QGLFramebufferObject::blitFramebuffer(_textureFbo, rect, _renderFbo, rect);
+  }
+
+  // Supersampled frames are downscaled when drawn: prefilter with mipmaps.
+  _hasMipmaps = (_renderScale > 1);
+  if (_hasMipmaps)
+  {
+    glBindTexture(GL_TEXTURE_2D, getTextureId());
+    QGLFunctions(QGLContext::currentContext()).glGenerateMipmap(GL_TEXTURE_2D);
+  }
+
+  _hasFrame = true;
+}
+
+void Compositor::draw(QPainter* painter, const QRectF& target) const
+{
+  if (!isValid())
+    return;
+
+  painter->beginNativePainting();
+
+  // The composition is opaque: no need to blend.
+  glDisable(GL_BLEND);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, getTextureId());
+
+  // Final scaling pass from internal to output resolution.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _hasMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+  // Framebuffer textures are stored bottom-up.
+  glBegin(GL_QUADS);
+  {
+    glTexCoord2f(0, 1); glVertex2f(target.left(),  target.top());
+    glTexCoord2f(1, 1); glVertex2f(target.right(), target.top());
+    glTexCoord2f(1, 0); glVertex2f(target.right(), target.bottom());
+    glTexCoord2f(0, 0); glVertex2f(target.left(),  target.bottom());
+  }
+  glEnd();
+
+  glDisable(GL_TEXTURE_2D);
+
+  painter->endNativePainting();
+}
+
+void Compositor::release()
+{
+  if (_renderFbo)
+  {
+    _shareWidget->makeCurrent();
+    if (_textureFbo != _renderFbo)
+      delete _textureFbo;
+    delete _renderFbo;
+  }
+
+  _renderFbo = _textureFbo = NULL;
+  _size = QSize();
+  _hasMipmaps = false;
+  _hasFrame = false;
+}
+
+GLuint Compositor::getTextureId() const
+{
+  return (_textureFbo ? _textureFbo->texture() : 0);
+}
+
+QImage Compositor::toImage() const
+{
+  if (!isValid())
+    return QImage();
+
+  _shareWidget->makeCurrent();
+  return _textureFbo->toImage();
+}
+
+void Compositor::_allocate(const QSize& size)
+{
+  release();
+
+  QGLFramebufferObjectFormat format;
+  format.setAttachment(QGLFramebufferObject::CombinedDepthStencil);
+
+  if (QGLFramebufferObject::hasOpenGLFramebufferBlit())
+  {
+    // Render multisampled, then resolve into a plain texture.
+    format.setSamples(4);
+    _renderFbo = new QGLFramebufferObject(size, format);
+
+    QGLFramebufferObjectFormat textureFormat;
+    _textureFbo = new QGLFramebufferObject(size, textureFormat);
+  }
+  else
+  {
+    _renderFbo = _textureFbo = new QGLFramebufferObject(size, format);
+  }
+
+  _size = size;
+}
+
+}
@@ -0,0 +1,129 @@
+/*
+ * Compositor.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPOSITOR_H_
+#define COMPOSITOR_H_
+
+#include <QtGlobal>
+
+#if __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <QGLWidget>
+#include <QGLFramebufferObject>
+#include <QGLFunctions>
+#include <QGraphicsScene>
+#include <QPainter>
+
+#include "NativeRenderer.h"
+
+namespace mmp {
+
+/**
+ * Renders the output composition (ie. the destination scene) once per frame into an
+ * offscreen framebuffer at an internal resolution (output resolution times the render
+ * scale). The resulting texture is shared by the output windows, which scale it to their
+ * size, and by the destination editor, which draws it scaled and only paints the
+ * controls on top.
+ */
+class Compositor
+{
+public:
+  /// Constructor. Framebuffers live in the GL context of shareWidget.
+  Compositor(const QGLWidget* shareWidget);
+  virtual ~Compositor();
+
+  /// Renders the sceneRect region of scene for an output of given size (see setRenderScale()).
+  void render(QGraphicsScene* scene, const QRectF& sceneRect, const QSize& outputSize);
+
+  /**
+   * Sets the internal render resolution relative to output size: eg. 0.5 renders at half
+   * resolution (faster), 2 supersamples (sharper). Applied on next render().
+   */
+  void setRenderScale(qreal scale) { _renderScale = qMax(scale, qreal(0.1)); }
+
+  /// Returns the internal render resolution relative to output size.
+  qreal getRenderScale() const { return _renderScale; }
+
+  /**
+   * Sets whether the composition is rendered natively from the visible mappings
+   * (see NativeRenderer) rather than by painting the items of the scene.
+   */
+  void setNativeRendering(bool native) { _nativeRendering = native; }
+
+  /// Returns true iff the composition is rendered natively.
+  bool isNativeRendering() const { return _nativeRendering; }
+
+  /// Draws the last rendered frame inside target (in painter coordinates).
+  void draw(QPainter* painter, const QRectF& target) const;
+
+  /// Frees the framebuffers; the compositor becomes invalid until next render().
+  void release();
+
+  /// Returns true iff a frame has been rendered and can be drawn.
+  bool isValid() const { return _hasFrame; }
+
+  /// Returns the scene region covered by the last rendered frame.
+  const QRectF& getSceneRect() const { return _sceneRect; }
+
+  /// Returns the size (in pixels) of the framebuffer (ie. the internal resolution).
+  const QSize& getSize() const { return _size; }
+
+  /// Returns the id of the texture holding the last rendered frame.
+  GLuint getTextureId() const;
+
+  /// Returns the framebuffer holding the last rendered frame (NULL if none).
+  QGLFramebufferObject* getFramebuffer() const { return _textureFbo; }
+
+  /// Reads back the last rendered frame (slow: stalls the pipeline).
+  QImage toImage() const;
+
+private:
+  void _allocate(const QSize& size);
+
+  // Widget whose GL context owns the framebuffers.
+  QGLWidget* _shareWidget;
+
+  // Framebuffer the scene is rendered into (multisampled when supported).
+  QGLFramebufferObject* _renderFbo;
+
+  // Single-sampled framebuffer holding the texture (same as _renderFbo if no multisampling).
+  QGLFramebufferObject* _textureFbo;
+
+  // Renders mappings directly when native rendering is on.
+  NativeRenderer _nativeRenderer;
+  bool _nativeRendering;
+
+  // Internal resolution relative to output.
+  qreal _renderScale;
+
+  // True iff the texture has mipmaps (used to downscale supersampled frames).
+  bool _hasMipmaps;
+
+  QRectF _sceneRect;
+  QSize _size;
+  bool _hasFrame;
+};
+
+}
+
+#endif /* COMPOSITOR_H_ */
@@ -0,0 +1,237 @@
+/*
+ * FrameClock.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameClock.h"
+
+#include <QApplication>
+#include <QDesktopWidget>
+#include <QScreen>
+#include <QtMath>
+
+#include "MM.h"
+
+// Presentation timestamps (GLX_OML_sync_control). Included last: Xlib defines clash with Qt.
+#ifdef UNIX
+#include <GL/glx.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+namespace mmp {
+
+FrameClock::FrameClock(QObject* parent)
+  : QObject(parent),
+    _pacer(NULL),
+    _framesPerSecond(MM::DEFAULT_FRAMES_PER_SECOND),
+    _active(false)
+{
+  _timer = new QTimer(this);
+  _timer->setTimerType(Qt::PreciseTimer);
+  connect(_timer, SIGNAL(timeout()), this, SLOT(_tick()));
+
+  _elapsed.start();
+  resetStatistics();
+}
+
+void FrameClock::setFramesPerSecond(qreal fps)
+{
+  _framesPerSecond = qMax(fps, 1.0);
+
+  // In paced mode the interval is only used as a watchdog (see _tick()).
+  if (!isVsyncPaced())
+    _timer->setInterval( int( 1000 / _framesPerSecond ) );
+}
+
+void FrameClock::setPacer(QGraphicsView* pacer)
+{
+  if (pacer == _pacer)
+    return;
+
+  _pacer = pacer;
+  _timer->setSingleShot(isVsyncPaced());
+  _timer->setInterval( int( 1000 / _framesPerSecond ) );
+  resetStatistics();
+
+  if (_active)
+    _timer->start();
+}
+
+qreal FrameClock::getRefreshRate() const
+{
+  if (isVsyncPaced())
+  {
+    int screen = QApplication::desktop()->screenNumber(_pacer);
+    QList<QScreen*> screens = QApplication::screens();
+    if (0 <= screen && screen < screens.size())
+      return screens[screen]->refreshRate();
+  }
+  return _framesPerSecond;
+}
+
+void FrameClock::start()
+{
+  _active = true;
+  _lastFrameTime = -1;
+  _timer->start();
+}
+
+void FrameClock::stop()
+{
+  _active = false;
+  _timer->stop();
+}
+
+int FrameClock::getFrameTimePercentile(qreal proportion) const
+{
+  int threshold = qCeil(qBound(0.0, proportion, 1.0) * _frameCount);
+  int count = 0;
+  for (int i=0; i<HISTOGRAM_N_BINS; i++)
+  {
+    count += _histogram[i];
+    if (count >= threshold && count > 0)
+      return i;
+  }
+  return HISTOGRAM_N_BINS - 1;
+}
+
+qreal FrameClock::getAverageFrameTime() const
+{
+  return (_frameCount ? _totalFrameTime / (1000.0 * _frameCount) : 0);
+}
+
+void FrameClock::resetStatistics()
+{
+  _histogram.fill(0, HISTOGRAM_N_BINS);
+  _totalFrameTime = 0;
+  _frameCount = 0;
+  _missedVsyncs = 0;
+  _lastFrameTime = -1;
+  _lastVsyncCounter = -1;
+}
+
+void FrameClock::framePresented()
+{
+  if (!_active || !isVsyncPaced())
+    return;
+
+  // Only the pacer drives the clock (other outputs are presented at the same time).
+  if (sender() && sender() != _pacer)
+    return;
+
+  // Wait for the swap to actually happen so that the next frame starts right after vsync.
+  static_cast<QGLWidget*>(_pacer->viewport())->makeCurrent();
+  glFinish();
+
+  qint64 time;
+  qint64 counter;
+  bool hasCounter = _getPresentationTime(&time, &counter);
+
+  if (_lastFrameTime >= 0)
+  {
+    qint64 frameTime = time - _lastFrameTime;
+    _addFrameTime(frameTime);
+
+    // Count vsyncs elapsed since last frame: anything above one was missed.
+    int nVsyncs;
+    if (hasCounter && _lastVsyncCounter >= 0)
+      nVsyncs = int(counter - _lastVsyncCounter);
+    else
+      nVsyncs = qRound(frameTime * getRefreshRate() / 1000000.0);
+    _missedVsyncs += qMax(nVsyncs - 1, 0);
+  }
+
+  _lastFrameTime = time;
+  _lastVsyncCounter = (hasCounter ? counter : -1);
+
+  // Immediately request next frame.
+  _timer->start(0);
+}
+
+void FrameClock::frameSkipped()
+{
+  // In timer mode ticks keep their regular rhythm: only presentation times are affected.
+  if (isVsyncPaced())
+  {
+    _lastFrameTime = -1;
+    _lastVsyncCounter = -1;
+  }
+}
+
+void FrameClock::_tick()
+{
+  if (isVsyncPaced())
+  {
+    // Watchdog: keep running at nominal rate if the pacer stops presenting (eg. hidden).
+    _timer->start( int( 1000 / _framesPerSecond ) );
+  }
+  else
+  {
+    qint64 time = _elapsed.nsecsElapsed() / 1000;
+    if (_lastFrameTime >= 0)
+      _addFrameTime(time - _lastFrameTime);
+    _lastFrameTime = time;
+  }
+
+  emit frame();
+}
+
+void FrameClock::_addFrameTime(qint64 frameTime)
+{
+  int bin = qBound(0, int(frameTime / 1000), HISTOGRAM_N_BINS - 1);
+  _histogram[bin]++;
+  _totalFrameTime += frameTime;
+  _frameCount++;
+}
+
+bool FrameClock::_getPresentationTime(qint64* time, qint64* counter)
+{
+#ifdef UNIX
+  typedef Bool (*GetSyncValuesOMLProc)(Display*, GLXDrawable, int64_t*, int64_t*, int64_t*);
+  static GetSyncValuesOMLProc getSyncValues = NULL;
+  static bool initialized = false;
+
+  Display* display = glXGetCurrentDisplay();
+  GLXDrawable drawable = glXGetCurrentDrawable();
+  if (display && drawable)
+  {
+    if (!initialized)
+    {
+      const char* extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+      if (extensions && strstr(extensions, "GLX_OML_sync_control"))
+        getSyncValues = (GetSyncValuesOMLProc) glXGetProcAddressARB((const GLubyte*) "glXGetSyncValuesOML");
+      initialized = true;
+    }
+
+    int64_t ust, msc, sbc;
+    if (getSyncValues && getSyncValues(display, drawable, &ust, &msc, &sbc))
+    {
+      *time = ust;
+      *counter = msc;
+      return true;
+    }
+  }
+#else
+  Q_UNUSED(counter);
+#endif
+
+  *time = _elapsed.nsecsElapsed() / 1000;
+  return false;
+}
+
+}
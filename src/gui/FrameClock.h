@@ -0,0 +1,123 @@
+/*
+ * FrameClock.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECLOCK_H_
+#define FRAMECLOCK_H_
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QGLWidget>
+#include <QGraphicsView>
+
+namespace mmp {
+
+/**
+ * Drives the render loop. When a pacer view is set (an output canvas, whose buffer
+ * swaps are synced to the display refresh) a new frame is requested as soon as the
+ * previous one has been presented, so that rendering is locked to vsync. Without a
+ * pacer the clock falls back to a regular timer at the requested frame rate.
+ *
+ * The clock also keeps a histogram of frame times and counts missed vsyncs.
+ */
+class FrameClock : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// Number of bins in the frame time histogram (1 ms per bin, last bin includes longer frames).
+  static const int HISTOGRAM_N_BINS = 100;
+
+  FrameClock(QObject* parent = 0);
+  virtual ~FrameClock() {}
+
+  /// Sets the frame rate used when the clock is not paced by a widget.
+  void setFramesPerSecond(qreal fps);
+  qreal getFramesPerSecond() const { return _framesPerSecond; }
+
+  /// Sets the view (with a GL viewport) whose buffer swaps pace the clock (NULL to use the timer).
+  void setPacer(QGraphicsView* pacer);
+  QGraphicsView* getPacer() const { return _pacer; }
+
+  /// Returns true iff the clock is currently locked to buffer swaps.
+  bool isVsyncPaced() const { return _pacer != NULL; }
+
+  /// Returns the refresh rate of the screen the pacer is on (or the timer frame rate).
+  qreal getRefreshRate() const;
+
+  void start();
+  void stop();
+  bool isActive() const { return _active; }
+
+  /// Returns the frame time histogram (number of frames per millisecond bin).
+  const QVector<int>& getFrameTimeHistogram() const { return _histogram; }
+
+  /// Returns the frame time (in ms) under which the given proportion of frames fall.
+  int getFrameTimePercentile(qreal proportion) const;
+
+  /// Returns the average frame time (in ms).
+  qreal getAverageFrameTime() const;
+
+  /// Returns the number of vsyncs missed while paced.
+  int getMissedVsyncs() const { return _missedVsyncs; }
+
+  /// Returns the number of frames accounted for in statistics.
+  int getFrameCount() const { return _frameCount; }
+
+  void resetStatistics();
+
+public slots:
+  /// Must be called by the pacer once its buffers have been swapped (calls from other views are ignored).
+  void framePresented();
+
+  /// Should be called when a frame was not rendered (idle) so that the gap is not counted.
+  void frameSkipped();
+
+signals:
+  /// Emitted when a new frame should be processed.
+  void frame();
+
+private slots:
+  void _tick();
+
+private:
+  void _addFrameTime(qint64 frameTime);
+  bool _getPresentationTime(qint64* time, qint64* counter);
+
+  QTimer* _timer;
+  QElapsedTimer _elapsed;
+
+  QGraphicsView* _pacer;
+  qreal _framesPerSecond;
+  bool _active;
+
+  // Timestamp (in microseconds) and vsync counter of last frame (-1 if none).
+  qint64 _lastFrameTime;
+  qint64 _lastVsyncCounter;
+
+  QVector<int> _histogram;
+  qint64 _totalFrameTime;
+  int _frameCount;
+  int _missedVsyncs;
+};
+
+}
+
+#endif /* FRAMECLOCK_H_ */
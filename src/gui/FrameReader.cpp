@@ -0,0 +1,139 @@
+/*
+ * FrameReader.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameReader.h"
+
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+namespace mmp {
+
+FrameReader::FrameReader(const QGLWidget* shareWidget, int nBuffers)
+  : _shareWidget(const_cast<QGLWidget*>(shareWidget)),
+    _next(0),
+    _nPending(0),
+    _mapped(-1)
+{
+  Q_CHECK_PTR(_shareWidget);
+
+  // Buffers are implicitly shared: construct each one separately.
+  for (int i=0; i<qMax(nBuffers, 1); i++)
+    _buffers.append(QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer));
+  nBuffers = _buffers.size();
+  _sizes.resize(nBuffers);
+  _timestamps.resize(nBuffers);
+
+  _clock.start();
+}
+
+FrameReader::~FrameReader()
+{
+  release();
+}
+
+void FrameReader::read(QGLFramebufferObject* fbo)
+{
+  Q_ASSERT(_mapped < 0);
+  _shareWidget->makeCurrent();
+
+  // Ring is full: drop oldest frame.
+  if (_nPending == _buffers.size())
+    _nPending--;
+
+  QOpenGLBuffer& buffer = _buffers[_next];
+  QSize size = fbo->size();
+  int nBytes = size.width() * size.height() * 4;
+
+  if (!buffer.isCreated())
+  {
+    buffer.setUsagePattern(QOpenGLBuffer::StreamRead);
+    buffer.create();
+  }
+  buffer.bind();
+  if (buffer.size() != nBytes)
+    buffer.allocate(nBytes);
+
+  // Read into buffer: returns immediately, the transfer happens in the background.
+  fbo->bind();
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, size.width(), size.height(), GL_BGRA, GL_UNSIGNED_BYTE, 0);
+  fbo->release();
+
+  buffer.release();
+
+  _sizes[_next] = size;
+  _timestamps[_next] = _clock.nsecsElapsed();
+  _next = (_next + 1) % _buffers.size();
+  _nPending++;
+}
+
+const uchar* FrameReader::mapFrame(QSize* size, qint64* timestamp, bool flush)
+{
+  Q_ASSERT(_mapped < 0);
+
+  if (_nPending == 0 || (_nPending < _buffers.size() && !flush))
+    return NULL;
+
+  // Buffers can only be mapped in their own context (eg. when flushing from a menu action).
+  _shareWidget->makeCurrent();
+
+  // Oldest frame (only considered done once it could be mapped).
+  int oldest = (_next - _nPending + _buffers.size()) % _buffers.size();
+  QOpenGLBuffer& buffer = _buffers[oldest];
+  buffer.bind();
+  const uchar* bits = static_cast<const uchar*>(buffer.map(QOpenGLBuffer::ReadOnly));
+  if (!bits)
+  {
+    buffer.release();
+    return NULL;
+  }
+  _mapped = oldest;
+  _nPending--;
+
+  if (size)
+    *size = _sizes[_mapped];
+  if (timestamp)
+    *timestamp = _timestamps[_mapped];
+  return bits;
+}
+
+void FrameReader::unmapFrame()
+{
+  if (_mapped < 0)
+    return;
+
+  _shareWidget->makeCurrent();
+  QOpenGLBuffer& buffer = _buffers[_mapped];
+  buffer.unmap();
+  buffer.release();
+  _mapped = -1;
+}
+
+void FrameReader::release()
+{
+  _shareWidget->makeCurrent();
+  unmapFrame();
+  for (int i=0; i<_buffers.size(); i++)
+    _buffers[i].destroy();
+
+  _next = _nPending = 0;
+}
+
+}
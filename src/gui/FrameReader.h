@@ -0,0 +1,89 @@
+/*
+ * FrameReader.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_READER_H_
+#define FRAME_READER_H_
+
+#include <QElapsedTimer>
+#include <QGLFramebufferObject>
+#include <QGLWidget>
+#include <QOpenGLBuffer>
+#include <QVector>
+
+#include "MM.h"
+
+namespace mmp {
+
+/**
+ * Reads back rendered frames from the GPU without stalling the pipeline.
+ *
+ * Each frame is read into the next pixel buffer object of a ring; the transfer
+ * happens asynchronously and the frame is only mapped (ie. made available to the
+ * CPU) nBuffers-1 frames later, once it is most likely over. Pixels are 32-bit BGRA
+ * stored bottom-up, as in GL.
+ */
+class FrameReader
+{
+public:
+  /// Constructor. Buffers live in the GL context of shareWidget.
+  FrameReader(const QGLWidget* shareWidget, int nBuffers = MM::FRAME_READER_N_BUFFERS);
+  virtual ~FrameReader();
+
+  /// Starts reading back the content of fbo (which must live in the GL context of shareWidget).
+  void read(QGLFramebufferObject* fbo);
+
+  /**
+   * Maps the oldest frame being read if the ring is full (or if flush is true and
+   * there is any) and returns its pixels, or NULL if there is none. Size and
+   * timestamp (in nanoseconds) of the frame are returned as well. Must be followed
+   * by unmapFrame().
+   */
+  const uchar* mapFrame(QSize* size, qint64* timestamp, bool flush = false);
+
+  /// Unmaps the frame returned by mapFrame() (pixels become invalid).
+  void unmapFrame();
+
+  /// Returns the number of frames being read.
+  int nPendingFrames() const { return _nPending; }
+
+  /// Frees the buffers (pending frames are lost).
+  void release();
+
+private:
+  // Widget whose GL context owns the buffers.
+  QGLWidget* _shareWidget;
+
+  // Ring of buffers with the size and timestamp of the frame they hold.
+  QVector<QOpenGLBuffer> _buffers;
+  QVector<QSize> _sizes;
+  QVector<qint64> _timestamps;
+
+  // Index of next buffer to read into, and number of frames being read.
+  int _next;
+  int _nPending;
+
+  // Buffer currently mapped (-1 if none).
+  int _mapped;
+
+  QElapsedTimer _clock;
+};
+
+}
+
+#endif /* FRAME_READER_H_ */
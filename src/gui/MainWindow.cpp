@@ -22,6 +22,7 @@
 #include "MainWindow.h"
 #include "PreferenceDialog.h"
 #include "AboutDialog.h"
+#include "OutputCorrectionDialog.h"
 #include "Commands.h"
 #include "ProjectWriter.h"
 #include "ProjectReader.h"
@@ -54,6 +55,8 @@ MainWindow::MainWindow()
 
   // Frames per second.
   _framesPerSecond = (-1);
+  _canvasesNeedUpdate = true;
+  _unspannedOutputScreen = (-1);
 
   // Play state.
   _isPlaying = false;
@@ -68,6 +71,10 @@ MainWindow::MainWindow()
   // UndoStack
   undoStack = new QUndoStack(this);
 
+  // Frame clock (paced by output window buffer swaps when visible).
+  frameClock = new FrameClock(this);
+  connect(frameClock, SIGNAL(frame()), this, SLOT(processFrame()));
+
   // Create everything.
   createLayout();
   createActions();
@@ -92,11 +99,9 @@ MainWindow::MainWindow()
   // Allow drag n drop
   setAcceptDrops(true);
 
-  // Create and start timer.
-  videoTimer = new QTimer(this);
-  connect(videoTimer, SIGNAL(timeout()), this, SLOT(processFrame()));
+  // Start frame clock.
   setFramesPerSecond(MM::DEFAULT_FRAMES_PER_SECOND);
-  videoTimer->start();
+  frameClock->start();
 
   // Create elapsed timer.
   systemTimer = new QElapsedTimer;
@@ -108,6 +113,10 @@ MainWindow::MainWindow()
 
 MainWindow::~MainWindow()
 {
+  delete videoRecorder;
+  delete sharedMemoryOutput;
+  delete frameReader;
+  delete compositor;
   delete mappingManager;
   //  delete _facade;
 #ifdef HAVE_OSC
@@ -323,8 +332,6 @@ void MainWindow::mappingPropertyChanged(uid id, QString propertyName, QVariant v
   {
     mappingListModel->setData(index, mapping->isLocked(), Qt::CheckStateRole + 2);
   }
-
-  updatePlayingState();
 }
 
 void MainWindow::paintPropertyChanged(uid id, QString propertyName, QVariant value)
@@ -343,8 +350,6 @@ void MainWindow::paintPropertyChanged(uid id, QString propertyName, QVariant val
   QListWidgetItem* paintItem = getItemFromId(*paintList, id);
   if (propertyName == "name")
     paintItem->setText(paint->getName());
-
-  updatePlayingState();
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
@@ -486,7 +491,7 @@ void MainWindow::dropEvent(QDropEvent *event)
 
 void MainWindow::setOutputWindowFullScreen(bool enable)
 {
-  outputWindow->setFullScreen(enable);
+  setOutputsFullScreen(enable);
   // setCheckState
   displayControlsAction->setChecked(enable);
   displayPaintControlsAction->setChecked(enable);
@@ -825,8 +830,8 @@ void MainWindow::deleteItem()
   {
     if (isMappingTabSelected) //currentSelectedItem->listWidget() == mappingList)
     {
-      // Delete mapping.
-      undoStack->push(new DeleteMappingCommand(this, getCurrentMappingId()));
+      // Delete mapping(s).
+      deleteMappingItem();
       //currentSelectedItem = NULL;
     }
     else if (isPaintTabSelected) //currentSelectedItem->listWidget() == paintList)
@@ -844,7 +849,13 @@ void MainWindow::deleteItem()
 
 void MainWindow::duplicateMappingItem()
 {
-  if (currentSelectedIndex.isValid())
+  // Many layers selected: duplicate them all at once (single undo step).
+  QVector<uid> selectedIds = selectedMappingIds();
+  if (selectedIds.size() > 1)
+  {
+    duplicateMappings(selectedIds);
+  }
+  else if (currentSelectedIndex.isValid())
   {
     duplicateMapping(currentMappingItemId());
   }
@@ -856,7 +867,13 @@ void MainWindow::duplicateMappingItem()
 
 void MainWindow::deleteMappingItem()
 {
-  if (hasCurrentMapping())
+  // Many layers selected: delete them all at once (single undo step).
+  QVector<uid> selectedIds = selectedMappingIds();
+  if (selectedIds.size() > 1)
+  {
+    undoStack->push(new DeleteMappingsCommand(this, selectedIds));
+  }
+  else if (hasCurrentMapping())
   {
     undoStack->push(new DeleteMappingCommand(this, getCurrentMappingId()));
   }
@@ -988,6 +1005,178 @@ void MainWindow::setupOutputScreen()
   }
 }
 
+void MainWindow::setOutputsFullScreen(bool fullscreen)
+{
+  foreach (OutputGLWindow* window, getOutputWindows())
+    window->setFullScreen(fullscreen);
+}
+
+void MainWindow::spanOutputAcrossScreens(bool span)
+{
+  removeExtraOutputWindows();
+
+  if (span)
+  {
+    // Remember the chosen screen to restore it afterwards.
+    if (_unspannedOutputScreen < 0)
+      _unspannedOutputScreen = outputWindow->getPreferredScreen();
+
+    // One output per screen, the composition having the layout of the virtual desktop.
+    QDesktopWidget* desktop = QApplication::desktop();
+    QPoint origin = desktop->geometry().topLeft();
+    for (int screen=0; screen<desktop->screenCount(); screen++)
+    {
+      QRect region = desktop->screenGeometry(screen).translated(-origin);
+      if (screen == 0)
+      {
+        outputWindow->setPreferredScreen(screen);
+        outputWindow->setOutputRegion(region);
+      }
+      else
+        addOutputWindow(screen, region);
+    }
+  }
+  else
+  {
+    if (_unspannedOutputScreen >= 0)
+      outputWindow->setPreferredScreen(_unspannedOutputScreen);
+    _unspannedOutputScreen = (-1);
+    outputWindow->setOutputRegion(QRect());
+  }
+
+  // Keep output screen menu in sync.
+  int preferredScreen = outputWindow->getPreferredScreen();
+  if (preferredScreen >= 0 && preferredScreen < screenActions.size())
+    screenActions.at(preferredScreen)->setChecked(true);
+
+  // Apply immediately if output is displayed.
+  if (outputFullScreenAction->isChecked())
+    setOutputsFullScreen(true);
+
+  updateCanvases();
+}
+
+void MainWindow::recordOutput(bool record)
+{
+  if (record)
+  {
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    tr("Record output"), settings.value("defaultVideoDir").toString(),
+                                                    tr("MP4 video files (*.mp4)"));
+    if (fileName.isEmpty())
+    {
+      // Cancelled: uncheck action without calling back.
+      recordOutputAction->blockSignals(true);
+      recordOutputAction->setChecked(false);
+      recordOutputAction->blockSignals(false);
+      return;
+    }
+
+    if (QFileInfo(fileName).suffix().isEmpty())
+      fileName.append(".mp4");
+
+    videoRecorder->setFilename(fileName);
+    videoRecorder->start(frameClock->getRefreshRate());
+
+    // Make sure at least one frame gets recorded.
+    updateCanvases();
+    statusBar()->showMessage(tr("Recording output to %1").arg(fileName), 2000);
+  }
+  else
+  {
+    // Send frames still being read back.
+    _sendOutputFrames(true);
+    videoRecorder->stop();
+
+    // Recording is finalized in the background (see _pollFinishedFrameOutputs()).
+    if (videoRecorder->isFinishing())
+      statusBar()->showMessage(tr("Finishing recording..."));
+    else if (!videoRecorder->getError().isEmpty())
+      QMessageBox::warning(this, tr("Recording failed"), videoRecorder->getError());
+  }
+}
+
+void MainWindow::_pollFinishedFrameOutputs()
+{
+  if (videoRecorder->pollFinished())
+  {
+    if (videoRecorder->getError().isEmpty())
+      statusBar()->showMessage(tr("Recording saved (%1 frames, %2 dropped)")
+                               .arg(videoRecorder->getFrameCount())
+                               .arg(videoRecorder->getDroppedFrameCount()), 5000);
+    else
+      QMessageBox::warning(this, tr("Recording failed"), videoRecorder->getError());
+  }
+
+  sharedMemoryOutput->pollFinished();
+}
+
+OutputGLWindow* MainWindow::addOutputWindow(int screen, const QRect& region)
+{
+  OutputGLWindow* window = new OutputGLWindow(this, destinationCanvas);
+  window->installEventFilter(destinationCanvas);
+  window->setPreferredScreen(screen);
+  window->setOutputRegion(region);
+  window->setCanvasDisplayCrosshair(displayControlsAction->isChecked());
+  window->setContextMenuPolicy(Qt::CustomContextMenu);
+
+  // Shares the composition (rendered once for all outputs).
+  window->getCanvas()->setCompositor(compositor);
+
+  connect(displayControlsAction, SIGNAL(toggled(bool)), window, SLOT(setCanvasDisplayCrosshair(bool)));
+  connect(displayTestSignalAction, SIGNAL(toggled(bool)), window, SLOT(setDisplayTestSignal(bool)));
+  connect(window->getCanvas(), SIGNAL(shapeChanged(MShape*)), this, SLOT(updateCanvases()));
+  connect(window->getCanvas(), SIGNAL(shapeContextMenuRequested(const QPoint&)), this, SLOT(showMappingContextMenu(const QPoint&)));
+  connect(window->getCanvas(), SIGNAL(framePresented()), frameClock, SLOT(framePresented()));
+
+  extraOutputWindows.append(window);
+  _applyOutputCorrections();
+
+  if (outputFullScreenAction->isChecked())
+    window->setFullScreen(true);
+
+  return window;
+}
+
+void MainWindow::removeExtraOutputWindows()
+{
+  foreach (OutputGLWindow* window, extraOutputWindows)
+  {
+    if (frameClock->getPacer() == window->getCanvas())
+      frameClock->setPacer(NULL);
+    delete window;
+  }
+  extraOutputWindows.clear();
+}
+
+OutputCorrection::ptr MainWindow::getOutputCorrection(int output)
+{
+  while (outputCorrections.size() <= output)
+    outputCorrections.append(OutputCorrection::ptr(new OutputCorrection));
+  return outputCorrections[output];
+}
+
+void MainWindow::setOutputCorrection(int output, OutputCorrection::ptr correction)
+{
+  getOutputCorrection(output); // make room
+  outputCorrections[output] = correction;
+  _applyOutputCorrections();
+}
+
+void MainWindow::clearOutputCorrections()
+{
+  outputCorrections.clear();
+  _applyOutputCorrections();
+}
+
+void MainWindow::_applyOutputCorrections()
+{
+  QList<OutputGLWindow*> windows = getOutputWindows();
+  for (int i=0; i<windows.size(); i++)
+    windows[i]->setCorrection(getOutputCorrection(i));
+  updateCanvases();
+}
+
 void MainWindow::updateScreenCount()
 {
   // Clear action list before
@@ -1042,6 +1231,9 @@ bool MainWindow::clearProject()
   // Clear model.
   mappingManager->clearAll();
 
+  // Outputs are no longer corrected.
+  clearOutputCorrections();
+
   // Refresh GL canvases to clear them out.
   sourceCanvas->repaint();
   destinationCanvas->repaint();
@@ -1356,7 +1548,49 @@ void MainWindow::deleteMapping(uid mappingId)
   }
 }
 
+void MainWindow::deleteMappings(const QVector<uid>& mappingIds)
+{
+  // Cannot delete unexisting mappings (nor delete a mapping twice).
+  QVector<uid> existingIds;
+  QSet<uid> visitedIds;
+  foreach (uid mappingId, mappingIds)
+  {
+    if (Mapping::getUidAllocator().exists(mappingId) && mappers.contains(mappingId) &&
+        !visitedIds.contains(mappingId))
+    {
+      existingIds.push_back(mappingId);
+      visitedIds.insert(mappingId);
+    }
+  }
+  removeMappingItems(existingIds);
+}
+
 void MainWindow::duplicateMapping(uid mappingId)
+{
+  // Get duplicated mapping id
+  uid cloneId = mappingManager->addMapping(_cloneMapping(mappingId));
+
+  // Lets the undo-stack handle Undo/Redo the duplication of mapping item.
+  undoStack->push(new DuplicateMappingCommand(this, cloneId));
+}
+
+void MainWindow::duplicateMappings(const QVector<uid>& mappingIds)
+{
+  // Clone in layer order so that copies keep the same relative order.
+  QSet<uid> selectedIds = mappingIds.toList().toSet();
+  QVector<Mapping::ptr> clones;
+  for (int i=0; i<mappingManager->nMappings(); i++)
+  {
+    uid mappingId = mappingManager->getMapping(i)->getId();
+    if (selectedIds.contains(mappingId))
+      clones.push_back(_cloneMapping(mappingId));
+  }
+
+  if (!clones.isEmpty())
+    undoStack->push(new AddMappingsCommand(this, mappingManager->addMappings(clones)));
+}
+
+Mapping::ptr MainWindow::_cloneMapping(uid mappingId)
 {
   // Current Mapping
   Mapping::ptr currentMapping = mappingManager->getMappingById(mappingId);
@@ -1387,11 +1621,7 @@ void MainWindow::duplicateMapping(uid mappingId)
   else
     shape->translate(QPointF(0, 20));
 
-  // Get duplicated mapping id
-  uid cloneId = mappingManager->addMapping(clonedMappingPtr);
-
-  // Lets the undo-stack handle Undo/Redo the duplication of mapping item.
-  undoStack->push(new DuplicateMappingCommand(this, cloneId));
+  return clonedMappingPtr;
 }
 
 /// Deletes/removes a paint and all associated mappigns.
@@ -1437,7 +1667,7 @@ void MainWindow::createLayout()
 
   // Create mapping list.
   mappingList = new QTableView;
-  mappingList->setSelectionMode(QAbstractItemView::SingleSelection);
+  mappingList->setSelectionMode(QAbstractItemView::ExtendedSelection);
   mappingList->setSelectionBehavior(QAbstractItemView::SelectRows);
   mappingList->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
   mappingList->setDragEnabled(true);
@@ -1504,6 +1734,22 @@ void MainWindow::createLayout()
   outputWindow = new OutputGLWindow(this, destinationCanvas);
   outputWindow->installEventFilter(destinationCanvas);
 
+  // Share a single rendering of the composition between output and destination.
+  compositor = new Compositor((QGLWidget*)destinationCanvas->viewport());
+  destinationCanvas->setCompositor(compositor);
+  outputWindow->getCanvas()->setCompositor(compositor);
+  _applyOutputCorrections();
+
+  // Recording and publishing of the composition.
+  frameReader = new FrameReader((QGLWidget*)destinationCanvas->viewport());
+  videoRecorder = new VideoRecorder;
+  sharedMemoryOutput = new SharedMemoryOutput;
+
+  connect(outputWindow->getCanvas(), SIGNAL(framePresented()), frameClock, SLOT(framePresented()));
+
+  // Output correction dialog.
+  _outputCorrectionDialog = new OutputCorrectionDialog(this);
+
   // Source scene changed -> change destination.
   connect(sourceCanvas->scene(), SIGNAL(changed(const QList<QRectF>&)),
           destinationCanvas,     SLOT(update()));
@@ -1512,6 +1758,12 @@ void MainWindow::createLayout()
   connect(destinationCanvas->scene(), SIGNAL(changed(const QList<QRectF>&)),
           outputWindow->getCanvas(),  SLOT(update()));
 
+  // Shapes edited in canvases or changed by undo/redo -> redraw.
+  connect(sourceCanvas,      SIGNAL(shapeChanged(MShape*)), this, SLOT(updateCanvases()));
+  connect(destinationCanvas, SIGNAL(shapeChanged(MShape*)), this, SLOT(updateCanvases()));
+  connect(outputWindow->getCanvas(), SIGNAL(shapeChanged(MShape*)), this, SLOT(updateCanvases()));
+  connect(undoStack, SIGNAL(indexChanged(int)), this, SLOT(updateCanvases()));
+
   // Output changed -> change destinatioin
   // XXX si je decommente cette ligne alors quand je clique sur ajouter media ca gele...
   //  connect(outputWindow->getCanvas()->scene(), SIGNAL(changed(const QList<QRectF>&)),
@@ -1876,8 +2128,8 @@ void MainWindow::createActions()
   outputFullScreenAction->setChecked(false);
   outputFullScreenAction->setShortcutContext(Qt::ApplicationShortcut);
   addAction(outputFullScreenAction);
-  // Manage fullscreen/modal show of GL output window.
-  connect(outputFullScreenAction, SIGNAL(toggled(bool)), outputWindow, SLOT(setFullScreen(bool)));
+  // Manage fullscreen/modal show of GL output windows.
+  connect(outputFullScreenAction, SIGNAL(toggled(bool)), this, SLOT(setOutputsFullScreen(bool)));
   connect(QApplication::desktop(), SIGNAL(screenCountChanged(int)), this, SLOT(updateScreenCount()));
   // Create hiden action for closing output window
   QAction *closeOutput = new QAction(this);
@@ -1886,6 +2138,28 @@ void MainWindow::createActions()
   addAction(closeOutput);
   connect(closeOutput, SIGNAL(triggered(bool)), this, SLOT(exitFullScreen()));
 
+  // Span output windows across all screens.
+  spanOutputAction = new QAction(tr("&Span Output Across Screens"), this);
+  spanOutputAction->setToolTip(tr("Display one output window per screen, each showing its part of the output"));
+  spanOutputAction->setCheckable(true);
+  spanOutputAction->setChecked(false);
+  addAction(spanOutputAction);
+  connect(spanOutputAction, SIGNAL(toggled(bool)), this, SLOT(spanOutputAcrossScreens(bool)));
+
+  // Output correction (warp and edge blend).
+  outputCorrectionAction = new QAction(tr("Output &Correction..."), this);
+  outputCorrectionAction->setToolTip(tr("Warp and edge-blend each output"));
+  addAction(outputCorrectionAction);
+  connect(outputCorrectionAction, SIGNAL(triggered()), _outputCorrectionDialog, SLOT(show()));
+
+  // Record output to a video file.
+  recordOutputAction = new QAction(tr("&Record Output..."), this);
+  recordOutputAction->setToolTip(tr("Record the output composition to a video file"));
+  recordOutputAction->setCheckable(true);
+  recordOutputAction->setChecked(false);
+  addAction(recordOutputAction);
+  connect(recordOutputAction, SIGNAL(toggled(bool)), this, SLOT(recordOutput(bool)));
+
   // Toggle display of canvas controls.
   displayControlsAction = new QAction(tr("&Display Controls"), this);
   displayControlsAction->setShortcut(Qt::ALT + Qt::Key_C);
@@ -2144,6 +2418,9 @@ void MainWindow::createMenus()
   viewMenu->addAction(displayPaintControlsAction);
   outputScreenMenu = viewMenu->addMenu(tr("&Output screen"));
   outputScreenMenu->addActions(screenActions);
+  viewMenu->addAction(spanOutputAction);
+  viewMenu->addAction(outputCorrectionAction);
+  viewMenu->addAction(recordOutputAction);
   viewMenu->addSeparator();
   // Playback.
   viewMenu->addAction(playAction);
@@ -2334,12 +2611,33 @@ void MainWindow::readSettings()
   canvasSplitter->restoreState(settings.value("canvasSplitter").toByteArray());
   outputWindow->restoreGeometry(settings.value("outputWindow").toByteArray());
 
+  // Additional outputs (each with a screen and a region of the output).
+  QVariantList outputs = settings.value("outputs").toList();
+  if (!outputs.isEmpty())
+  {
+    QVariantMap mainOutput = outputs.takeFirst().toMap();
+    outputWindow->setPreferredScreen(mainOutput.value("screen", outputWindow->getPreferredScreen()).toInt());
+    outputWindow->setOutputRegion(mainOutput.value("region").toRect());
+    foreach (const QVariant& output, outputs)
+    {
+      QVariantMap map = output.toMap();
+      addOutputWindow(map.value("screen").toInt(), map.value("region").toRect());
+    }
+  }
+  spanOutputAction->blockSignals(true);
+  spanOutputAction->setChecked(settings.value("spanOutput", false).toBool());
+  spanOutputAction->blockSignals(false);
+
   // new in 0.1.2:
   outputFullScreenAction->setChecked(settings.value("displayOutputWindow", MM::DISPLAY_OUTPUT_WINDOW).toBool());
   displayTestSignalAction->setChecked(settings.value("displayTestSignal", MM::DISPLAY_TEST_SIGNAL).toBool());
   displayControlsAction->setChecked(settings.value("displayControls", MM::DISPLAY_CONTROLS).toBool());
   outputWindow->setCanvasDisplayCrosshair(settings.value("displayControls", MM::DISPLAY_CONTROLS).toBool());
   oscListeningPort = settings.value("oscListeningPort", MM::DEFAULT_OSC_PORT).toInt();
+  compositor->setNativeRendering(settings.value("nativeOutputRendering", MM::NATIVE_OUTPUT_RENDERING).toBool());
+  compositor->setRenderScale(settings.value("renderScale", MM::DEFAULT_RENDER_SCALE).toReal());
+  setSharedMemoryOutput(settings.value("sharedMemoryOutput", MM::SHARED_MEMORY_OUTPUT).toBool(),
+                        settings.value("sharedMemoryOutputPath", MM::DEFAULT_SHARED_MEMORY_OUTPUT_PATH).toString());
 
   // Update Recent files and video
   updateRecentFileActions();
@@ -2368,6 +2666,16 @@ void MainWindow::writeSettings()
   settings.setValue("mappingSplitter", mappingSplitter->saveState());
   settings.setValue("canvasSplitter", canvasSplitter->saveState());
   settings.setValue("outputWindow", outputWindow->saveGeometry());
+  QVariantList outputs;
+  foreach (OutputGLWindow* window, getOutputWindows())
+  {
+    QVariantMap output;
+    output["screen"] = window->getPreferredScreen();
+    output["region"] = window->getOutputRegion();
+    outputs.append(output);
+  }
+  settings.setValue("outputs", outputs);
+  settings.setValue("spanOutput", spanOutputAction->isChecked());
   settings.setValue("displayOutputWindow", outputFullScreenAction->isChecked());
   settings.setValue("displayTestSignal", displayTestSignalAction->isChecked());
   settings.setValue("displayControls", displayControlsAction->isChecked());
@@ -2693,6 +3001,26 @@ bool MainWindow::addColorPaint(const QColor& color)
 }
 
 void MainWindow::addPaintItem(uid paintId, const QIcon& icon, const QString& name)
+{
+  _createPaintGui(paintId, icon, name);
+  _paintItemsAdded(paintId);
+}
+
+void MainWindow::addPaintItems(const QVector<uid>& paintIds)
+{
+  if (paintIds.isEmpty())
+    return;
+
+  foreach (uid paintId, paintIds)
+  {
+    Paint::ptr paint = mappingManager->getPaintById(paintId);
+    Q_CHECK_PTR(paint);
+    _createPaintGui(paintId, paint->getIcon(), paint->getName());
+  }
+  _paintItemsAdded(paintIds.last());
+}
+
+void MainWindow::_createPaintGui(uid paintId, const QIcon& icon, const QString& name)
 {
   Paint::ptr paint = mappingManager->getPaintById(paintId);
   Q_CHECK_PTR(paint);
@@ -2713,8 +3041,6 @@ void MainWindow::addPaintItem(uid paintId, const QIcon& icon, const QString& nam
   paintGuis[paintId] = paintGui;
   QWidget* paintEditor = paintGui->getPropertiesEditor();
   paintPropertyPanel->addWidget(paintEditor);
-  paintPropertyPanel->setCurrentWidget(paintEditor);
-  paintPropertyPanel->setEnabled(true);
 
   // When paint value is changed, update canvases.
   //  connect(paintGui.get(), SIGNAL(valueChanged()),
@@ -2723,13 +3049,6 @@ void MainWindow::addPaintItem(uid paintId, const QIcon& icon, const QString& nam
   connect(paintGui.data(), SIGNAL(valueChanged(Paint::ptr)),
           this,            SLOT(handlePaintChanged(Paint::ptr)));
 
-  connect(paint.data(), SIGNAL(propertyChanged(uid, QString, QVariant)),
-          this,           SLOT(paintPropertyChanged(uid, QString, QVariant)));
-
-  // TODO: attention: if mapping is invisible canvases will be updated for no reason
-  connect(paint.data(), SIGNAL(propertyChanged(uid, QString, QVariant)),
-          this,           SLOT(updateCanvases()));
-
   // Add paint item to paintList widget.
   QListWidgetItem* item = new QListWidgetItem(icon, name);
   setItemId(*item, paintId); // TODO: could possibly be replaced by a Paint pointer
@@ -2740,12 +3059,21 @@ void MainWindow::addPaintItem(uid paintId, const QIcon& icon, const QString& nam
   // Set tooltip.
   item->setToolTip(QString("ID: %1").arg(paint->getId()));
 
+  // Add item to paint list.
+  paintList->addItem(item);
+}
+
+void MainWindow::_paintItemsAdded(uid lastPaintId)
+{
+  // Show last added paint.
+  paintPropertyPanel->setCurrentWidget(paintGuis[lastPaintId]->getPropertiesEditor());
+  paintPropertyPanel->setEnabled(true);
+
   // Switch to paint tab.
   contentTab->setCurrentWidget(paintSplitter);
 
-  // Add item to paint list.
-  paintList->addItem(item);
-  paintList->setCurrentItem(item);
+  // Select last added paint.
+  paintList->setCurrentItem(getItemFromId(*paintList, lastPaintId));
 
 	// Update mapping guis.
 	updateMappers();
@@ -2776,6 +3104,44 @@ void MainWindow::updatePaintItem(uid paintId, const QIcon& icon, const QString&
 }
 
 void MainWindow::addMappingItem(uid mappingId)
+{
+  addMappingItems(QVector<uid>() << mappingId);
+}
+
+void MainWindow::addMappingItems(const QVector<uid>& mappingIds)
+{
+  if (mappingIds.isEmpty())
+    return;
+
+  foreach (uid mappingId, mappingIds)
+    _createMappingGui(mappingId);
+
+  // Switch to mapping tab.
+  contentTab->setCurrentWidget(mappingSplitter);
+
+  // Keep list in layer order (items may have been restored below others).
+  QVector<uid> layerOrder;
+  for (int i=0; i<mappingManager->nMappings(); i++)
+    layerOrder.push_back(mappingManager->getMapping(i)->getId());
+  mappingListModel->reorderItems(layerOrder);
+
+  // Update list (once for all items) and select last added mapping.
+  mappingListModel->updateModel();
+  mappingPropertyPanel->setCurrentWidget(mappers[mappingIds.last()]->getPropertiesEditor());
+  mappingPropertyPanel->setEnabled(true);
+  setCurrentMapping(mappingIds.last());
+
+  // Update everything.
+  updateCanvases();
+
+  // Window was modified.
+  windowModified();
+
+  // Update playing state.
+  updatePlayingState();
+}
+
+void MainWindow::_createMappingGui(uid mappingId)
 {
   Mapping::ptr mapping = mappingManager->getMappingById(mappingId);
   Q_CHECK_PTR(mapping);
@@ -2843,8 +3209,6 @@ void MainWindow::addMappingItem(uid mappingId)
   mappers[mappingId] = mapper;
   QWidget* mapperEditor = mapper->getPropertiesEditor();
   mappingPropertyPanel->addWidget(mapperEditor);
-  mappingPropertyPanel->setCurrentWidget(mapperEditor);
-  mappingPropertyPanel->setEnabled(true);
 
   // When mapper value is changed, update canvases.
   connect(mapper.data(), SIGNAL(valueChanged()),
@@ -2860,50 +3224,52 @@ void MainWindow::addMappingItem(uid mappingId)
   connect(destinationCanvas, SIGNAL(shapeChanged(MShape*)),
           mapper.data(),     SLOT(updateShape(MShape*)));
 
-  connect(mapping.data(), SIGNAL(propertyChanged(uid, QString, QVariant)),
-          this,           SLOT(mappingPropertyChanged(uid, QString, QVariant)));
-
-  // TODO: attention: if mapping is invisible canvases will be updated for no reason
-  connect(mapping.data(), SIGNAL(propertyChanged(uid, QString, QVariant)),
-          this,           SLOT(updateCanvases()));
-
-  // Switch to mapping tab.
-  contentTab->setCurrentWidget(mappingSplitter);
-
-  // Add item to layerList widget.
+  // Add item to layerList widget (model is updated by caller).
   mappingListModel->addItem(mapping, icon, mapping->getName());
-  mappingListModel->updateModel();
-  setCurrentMapping(mappingId);
 
   // Add items to scenes.
   if (mapper->getInputGraphicsItem())
     sourceCanvas->scene()->addItem(mapper->getInputGraphicsItem().data());
   if (mapper->getGraphicsItem())
     destinationCanvas->scene()->addItem(mapper->getGraphicsItem().data());
-
-  // Window was modified.
-  windowModified();
-
-  // Update playing state.
-  updatePlayingState();
 }
 
 void MainWindow::removeMappingItem(uid mappingId)
 {
-  Mapping::ptr mapping = mappingManager->getMappingById(mappingId);
-  Q_CHECK_PTR(mapping);
+  removeMappingItems(QVector<uid>() << mappingId);
+}
+
+void MainWindow::removeMappingItems(const QVector<uid>& mappingIds)
+{
+  // Ignore duplicate ids.
+  QVector<uid> uniqueIds;
+  QSet<uid> removedIds;
+  foreach (uid mappingId, mappingIds)
+  {
+    if (!removedIds.contains(mappingId))
+    {
+      uniqueIds.push_back(mappingId);
+      removedIds.insert(mappingId);
+    }
+  }
 
-  // Remove mapping from model.
-  mappingManager->removeMapping(mappingId);
+  if (uniqueIds.isEmpty())
+    return;
 
-  // Remove associated mapper.
-  mappingPropertyPanel->removeWidget(mappers[mappingId]->getPropertiesEditor());
-  mappers.remove(mappingId);
+  // Remove mappings from model.
+  mappingManager->removeMappings(uniqueIds);
+
+  // Remove associated mappers.
+  foreach (uid mappingId, uniqueIds)
+  {
+    MappingGui::ptr mapper = mappers.take(mappingId);
+    Q_CHECK_PTR(mapper);
+    mappingPropertyPanel->removeWidget(mapper->getPropertiesEditor());
+  }
 
-  // Remove widget from mappingList.
-  int row = mappingListModel->getItemRowFromId(mappingId);
+  // Remove widgets from mappingList.
+  int row = mappingListModel->removeItems(removedIds);
   Q_ASSERT( row >= 0 );
-  mappingListModel->removeItem(row);
 
   // Update list.
   mappingListModel->updateModel();
@@ -2912,7 +3278,7 @@ void MainWindow::removeMappingItem(uid mappingId)
     removeCurrentMapping();
   else
   {
-    int nextSelectedRow = row == mappingListModel->rowCount() ? row - 1 : row;
+    int nextSelectedRow = qMin(row, mappingListModel->rowCount() - 1);
     QModelIndex index = mappingListModel->getIndexFromRow(nextSelectedRow);
     mappingList->selectionModel()->select(index, QItemSelectionModel::Select);
     mappingList->setCurrentIndex(index);
@@ -2930,31 +3296,62 @@ void MainWindow::removeMappingItem(uid mappingId)
 
 void MainWindow::removePaintItem(uid paintId)
 {
-  Paint::ptr paint = mappingManager->getPaintById(paintId);
-  Q_CHECK_PTR(paint);
+  removePaintItems(QVector<uid>() << paintId);
+}
 
-  // Remove all mappings associated with paint.
-  QMap<uid, Mapping::ptr> paintMappings = mappingManager->getPaintMappings(paint);
-  for (QMap<uid, Mapping::ptr>::const_iterator it = paintMappings.constBegin();
-       it != paintMappings.constEnd(); ++it) {
-    removeMappingItem(it.key());
+void MainWindow::removePaintItems(const QVector<uid>& paintIds)
+{
+  // Ignore duplicate ids.
+  QSet<uid> removedIds;
+  QVector<uid> uniqueIds;
+  foreach (uid paintId, paintIds)
+  {
+    if (!removedIds.contains(paintId))
+    {
+      uniqueIds.push_back(paintId);
+      removedIds.insert(paintId);
+    }
   }
-  // Remove paint from model.
-  Q_ASSERT( mappingManager->removePaint(paintId) );
 
-  // Remove associated mapper.
-  paintPropertyPanel->removeWidget(paintGuis[paintId]->getPropertiesEditor());
-  paintGuis.remove(paintId);
+  if (uniqueIds.isEmpty())
+    return;
+
+  // Remove all mappings associated with paints (at once).
+  QVector<uid> paintMappingIds;
+  foreach (uid paintId, uniqueIds)
+  {
+    Paint::ptr paint = mappingManager->getPaintById(paintId);
+    Q_CHECK_PTR(paint);
+    paintMappingIds += mappingManager->getPaintMappings(paint).keys().toVector();
+  }
+  removeMappingItems(paintMappingIds);
+
+  foreach (uid paintId, uniqueIds)
+  {
+    // Remove paint from model.
+    bool removed = mappingManager->removePaint(paintId);
+    Q_ASSERT( removed );
+    Q_UNUSED( removed );
+
+    // Remove associated mapper.
+    PaintGui::ptr paintGui = paintGuis.take(paintId);
+    Q_CHECK_PTR(paintGui);
+    paintPropertyPanel->removeWidget(paintGui->getPropertiesEditor());
+  }
 
   updateMappers();
 
-  // Remove widget from paintList.
-  int row = getItemRowFromId(*paintList, paintId);
-  Q_ASSERT( row >= 0 );
-  QListWidgetItem* item = paintList->takeItem(row);
-  if (item == currentSelectedItem)
-    currentSelectedItem = NULL;
-  delete item;
+  // Remove widgets from paintList.
+  for (int row = paintList->count() - 1; row >= 0; row--)
+  {
+    if (removedIds.contains(getItemId(*paintList->item(row))))
+    {
+      QListWidgetItem* item = paintList->takeItem(row);
+      if (item == currentSelectedItem)
+        currentSelectedItem = NULL;
+      delete item;
+    }
+  }
 
   // Update list.
   paintList->update();
@@ -3059,18 +3456,136 @@ MainWindow* MainWindow::window() {
 }
 
 void MainWindow::updateCanvases()
+{
+  // Actual redraw is deferred to next frame (see processFrame()).
+  _canvasesNeedUpdate = true;
+}
+
+void MainWindow::_deliverPropertyChanges()
+{
+  // Each changed property is delivered once, whatever the number of times it changed.
+  QList<Element::PropertyChanges> changes = Element::takePropertyChanges();
+  if (changes.isEmpty())
+    return;
+
+  bool needsUpdate = false;
+  foreach (const Element::PropertyChanges& change, changes)
+  {
+    uid id = change.id;
+    bool isMapping = (change.allocator == &Mapping::getUidAllocator());
+
+    // Skip elements that are not part of the project (eg. removed ones kept for undo).
+    if (isMapping ? !mappers.contains(id) : !paintGuis.contains(id))
+      continue;
+
+    // Changes of invisible elements do not show (except in the controls of current ones).
+    Element::ptr element;
+    if (isMapping)
+    {
+      Mapping::ptr mapping = mappingManager->getMappingById(id);
+      element = mapping;
+      if (mappingManager->mappingIsVisible(mapping) || (hasCurrentMapping() && getCurrentMappingId() == id))
+        needsUpdate = true;
+    }
+    else
+    {
+      Paint::ptr paint = mappingManager->getPaintById(id);
+      element = paint;
+      if (mappingManager->paintIsVisible(paint) || (hasCurrentPaint() && getCurrentPaintId() == id))
+        needsUpdate = true;
+    }
+    Q_CHECK_PTR(element);
+
+    const QMetaObject* metaObject = element->metaObject();
+    foreach (int index, change.properties)
+    {
+      QMetaProperty property = metaObject->property(index);
+      QString propertyName = property.name();
+      if (isMapping)
+      {
+        mappingPropertyChanged(id, propertyName, property.read(element.data()));
+
+        // Showing/hiding a layer changes what is rendered even if it is hidden now.
+        if (propertyName == "visible" || propertyName == "solo")
+          needsUpdate = true;
+      }
+      else
+        paintPropertyChanged(id, propertyName, property.read(element.data()));
+    }
+  }
+
+  updatePlayingState();
+  if (needsUpdate)
+    updateCanvases();
+}
+
+void MainWindow::_renderCanvases()
 {
   // Update scenes.
   sourceCanvas->scene()->update();
   destinationCanvas->scene()->update();
 
+  // Render composition once, covering the regions of all visible outputs (only needed when
+  // an output is visible, otherwise the destination canvas draws its items directly).
+  QRectF compositionRect;
+  foreach (OutputGLWindow* window, getOutputWindows())
+  {
+    if (window->isVisible())
+      compositionRect |= window->getCanvas()->sceneRect();
+  }
+
+  // Recording and publishing need the composition even when no output is displayed.
+  if (compositionRect.isEmpty() && _hasActiveFrameOutputs())
+    compositionRect = outputWindow->getCanvas()->sceneRect();
+
+  if (!compositionRect.isEmpty())
+  {
+    compositor->render(destinationCanvas->scene(), compositionRect, compositionRect.size().toSize());
+    _sendOutputFrames();
+  }
+  else if (compositor->isValid())
+    compositor->release();
+
   // Update canvases.
   sourceCanvas->update();
   destinationCanvas->update();
-  outputWindow->getCanvas()->update();
+  foreach (OutputGLWindow* window, getOutputWindows())
+    window->getCanvas()->update();
+}
 
-  // Update statut bar
-  updateStatusBar();
+void MainWindow::_sendOutputFrames(bool flush)
+{
+  bool recording = videoRecorder->isActive();
+
+  // Read back this frame (unless flushing) and send those that are available.
+  if (_hasActiveFrameOutputs() && !flush && compositor->isValid())
+    frameReader->read(compositor->getFramebuffer());
+
+  QSize size;
+  qint64 timestamp;
+  while (const uchar* bits = frameReader->mapFrame(&size, &timestamp, flush))
+  {
+    // Both outputs copy the same mapped frame.
+    if (videoRecorder->isActive())
+      videoRecorder->pushFrame(bits, size, timestamp);
+    if (sharedMemoryOutput->isActive())
+      sharedMemoryOutput->pushFrame(bits, size, timestamp);
+    frameReader->unmapFrame();
+  }
+
+  // Recording stopped on error: report it.
+  if (recording && !videoRecorder->isActive())
+    recordOutputAction->setChecked(false);
+}
+
+bool MainWindow::_paintsNeedRedraw() const
+{
+  for (int i=0; i<mappingManager->nPaints(); i++)
+  {
+    if (mappingManager->getPaint(i)->needsRedraw())
+      return true;
+  }
+  return false;
 }
 
 void MainWindow::updateMappers() {
@@ -3083,21 +3598,69 @@ void MainWindow::updateMappers() {
 
 void MainWindow::processFrame()
 {
-  // Number of frames processed (restarted every second).
+  // Number of frames rendered (restarted every second).
   static unsigned int nFrames = 0;
 
-  // Update canvases.
-  updateCanvases();
+  // Lock frame clock to buffer swaps of the first displayed output.
+  MapperGLCanvas* pacer = NULL;
+  foreach (OutputGLWindow* window, getOutputWindows())
+  {
+    if (window->isVisible())
+    {
+      pacer = window->getCanvas();
+      break;
+    }
+  }
+  frameClock->setPacer(pacer);
+
+  // Update guis with changes made since last frame (renderer reads values directly).
+  _deliverPropertyChanges();
+
+  // Redraw canvases only if something changed (otherwise stay idle).
+  if (_canvasesNeedUpdate || _paintsNeedRedraw())
+  {
+    _canvasesNeedUpdate = false;
+    _renderCanvases();
+    nFrames++;
+  }
+  else
+  {
+    frameClock->frameSkipped();
+
+    // Nothing new will be rendered for now: send the last frames still being read back
+    // (they would otherwise wait for the next renders).
+    if (frameReader->nPendingFrames() > 0)
+      _sendOutputFrames(true);
+  }
+
+  // Free outputs stopped since last frame once they are done.
+  _pollFinishedFrameOutputs();
+
+  // Update status bar.
+  updateStatusBar();
 
   // Update true FPS.
-  nFrames++;
-  if (nFrames > framesPerSecond())
+  qreal targetFramesPerSecond = frameClock->getRefreshRate();
+  if (systemTimer->elapsed() >= 1000)
   {
-    // This is the real time needed to process one second.
-    qreal trueFramesPerSecond = nFrames / systemTimer->restart() * 1000.0;
+    // Number of frames actually rendered in the last second (lower when idle).
+    qreal trueFramesPerSecond = nFrames * 1000.0 / systemTimer->restart();
     trueFramesPerSecondsLabel->setText(
         "FPS: " + QString::number(trueFramesPerSecond, 'f', 2) + " / " +
-        QString::number(framesPerSecond()  , 'f', 2));
+        QString::number(targetFramesPerSecond, 'f', 2));
+
+    // Frame pacing statistics.
+    QString pacing = tr("Frame time: %1 ms average, %2 ms median, %3 ms (99%)")
+        .arg(frameClock->getAverageFrameTime(), 0, 'f', 2)
+        .arg(frameClock->getFrameTimePercentile(0.5))
+        .arg(frameClock->getFrameTimePercentile(0.99));
+    if (frameClock->isVsyncPaced())
+      pacing += "\n" + tr("Missed vsyncs: %1").arg(frameClock->getMissedVsyncs());
+    if (videoRecorder->isActive())
+      pacing += "\n" + tr("Recording: %1 frames, %2 dropped")
+                          .arg(videoRecorder->getFrameCount())
+                          .arg(videoRecorder->getDroppedFrameCount());
+    trueFramesPerSecondsLabel->setToolTip(pacing);
     nFrames = 0;
   }
 }
@@ -3107,11 +3670,10 @@ void MainWindow::updatePlayingState()
   // Pause all paints that are not visible.
   if (isPlaying())
   {
-    QVector<Paint::ptr> visiblePaints = mappingManager->getVisiblePaints();
     for (int i=0; i<mappingManager->nPaints(); i++)
     {
       Paint::ptr paint = mappingManager->getPaint(i);
-      if (visiblePaints.contains(paint))
+      if (mappingManager->paintIsVisible(paint))
       {
         paint->play();
       }
@@ -3149,7 +3711,7 @@ void MainWindow::enableDisplayControls(bool display)
 void MainWindow::setFramesPerSecond(qreal fps)
 {
   _framesPerSecond = qMax(fps, 0.0);
-  videoTimer->setInterval( int( 1000 / _framesPerSecond ) );
+  frameClock->setFramesPerSecond(_framesPerSecond);
 }
 
 void MainWindow::enableDisplayPaintControls(bool display)
@@ -3357,6 +3919,14 @@ uid MainWindow::currentMappingItemId() const
   return mappingListModel->getItemId(currentSelectedIndex);
 }
 
+QVector<uid> MainWindow::selectedMappingIds() const
+{
+  QVector<uid> ids;
+  foreach (const QModelIndex& index, mappingList->selectionModel()->selectedRows())
+    ids.push_back(mappingListModel->getItemId(index));
+  return ids;
+}
+
 QIcon MainWindow::createColorIcon(const QColor &color) {
   QPixmap pixmap(100,100);
   pixmap.fill(color);
@@ -3471,6 +4041,30 @@ bool MainWindow::setOscPort(QString portNumber)
   return true;
 }
 
+void MainWindow::setNativeOutputRendering(bool native)
+{
+  compositor->setNativeRendering(native);
+  updateCanvases();
+}
+
+void MainWindow::setRenderScale(qreal scale)
+{
+  compositor->setRenderScale(scale);
+  updateCanvases();
+}
+
+void MainWindow::setSharedMemoryOutput(bool enabled, const QString& socketPath)
+{
+  // Restart so that path changes apply.
+  sharedMemoryOutput->stop();
+  if (enabled)
+  {
+    sharedMemoryOutput->setSocketPath(socketPath);
+    sharedMemoryOutput->start(frameClock->getRefreshRate());
+  }
+  updateCanvases();
+}
+
 void MainWindow::pollOscInterface()
 {
 #ifdef HAVE_OSC
@@ -42,9 +42,15 @@
 #endif
 
 #include "OutputGLWindow.h"
+#include "Compositor.h"
+#include "FrameClock.h"
+#include "FrameReader.h"
+#include "SharedMemoryOutput.h"
+#include "VideoRecorder.h"
 #include "ConsoleWindow.h"
 
 #include "MappingManager.h"
+#include "OutputCorrection.h"
 #include "MappingItemDelegate.h"
 #include "MappingListModel.h"
 
@@ -59,6 +65,7 @@ namespace mmp {
 
 class PreferenceDialog;
 class AboutDialog;
+class OutputCorrectionDialog;
 
 /**
  * This is the main window of MapMap. It acts as both a view and a controller interface.
@@ -124,6 +131,9 @@ private slots:
   // Output menu
   void setupOutputScreen();
   void updateScreenCount();
+  void setOutputsFullScreen(bool fullscreen);
+  void spanOutputAcrossScreens(bool span);
+  void recordOutput(bool record);
 
   // Widget callbacks.
   void handlePaintItemSelectionChanged();
@@ -134,6 +144,7 @@ private slots:
   void handlePaintItemSelected(QListWidgetItem* item);
   void handlePaintChanged(Paint::ptr paint);
 
+  /// Updates guis after a property of a mapping/paint changed (see _deliverPropertyChanges()).
   void mappingPropertyChanged(uid id, QString propertyName, QVariant value);
   void paintPropertyChanged(uid id, QString propertyName, QVariant value);
 
@@ -226,21 +237,28 @@ public slots:
   /// Deletes/removes a mapping.
   void deleteMapping(uid mappingId);
 
+  /// Deletes/removes a set of mappings at once.
+  void deleteMappings(const QVector<uid>& mappingIds);
+
   /// Clone/duplicate a mapping
   void duplicateMapping(uid mappingId);
 
+  /// Clone/duplicate a set of mappings at once.
+  void duplicateMappings(const QVector<uid>& mappingIds);
+
   /// Deletes/removes a paint and all associated mappigns.
   void deletePaint(uid paintId, bool replace = false);
 
-  /// Updates all canvases.
+  /// Marks all canvases as needing an update: they will be redrawn at next frame.
   void updateCanvases();
 
 	/// Update all mapping guis.
 	void updateMappers();
 
   /**
-   * This function is triggered framesPerSeconds() times per second. It makes sure
-   * the image is refreshed (updateCanvases()) and performs other necessary operations.
+   * This function is triggered by the frame clock. It makes sure the image is refreshed
+   * if anything changed since last frame (see updateCanvases()) and performs other
+   * necessary operations. When nothing changed no rendering is done at all.
    */
   void processFrame();
 
@@ -297,6 +315,37 @@ private:
   // Actions-related.
   bool okToContinue();
 
+  // Creates gui of a paint and adds it to the paint list.
+  void _createPaintGui(uid paintId, const QIcon& icon, const QString& name);
+
+  // Selects last added paint and updates everything after paint items were added.
+  void _paintItemsAdded(uid lastPaintId);
+
+  // Creates gui of a mapping, adds it to the list model and its items to canvases.
+  void _createMappingGui(uid mappingId);
+
+  // Returns a copy of given mapping, slightly offset (not yet added to the manager).
+  Mapping::ptr _cloneMapping(uid mappingId);
+
+  // Sends property changes of mappings and paints recorded since last frame to guis.
+  void _deliverPropertyChanges();
+
+  // Rendering.
+  void _renderCanvases();
+  bool _paintsNeedRedraw() const;
+
+  // Returns true iff the composition is being recorded or published.
+  bool _hasActiveFrameOutputs() const { return videoRecorder->isActive() || sharedMemoryOutput->isActive(); }
+
+  // Reads back the composition and sends it to active frame outputs (flush sends all pending frames).
+  void _sendOutputFrames(bool flush = false);
+
+  // Frees stopped frame outputs once they are done and reports the end of recordings.
+  void _pollFinishedFrameOutputs();
+
+  // Hands its correction to each output canvas.
+  void _applyOutputCorrections();
+
 public:
   bool loadFile(const QString &fileName);
   bool saveFile(const QString &fileName);
@@ -306,7 +355,15 @@ public:
   bool addColorPaint(const QColor& color);
   void addMappingItem(uid mappingId);
   void removeMappingItem(uid mappingId);
+
+  /// Adds/removes the items of many mappings at once (with a single list and canvas update).
+  void addMappingItems(const QVector<uid>& mappingIds);
+  void removeMappingItems(const QVector<uid>& mappingIds);
   void addPaintItem(uid paintId, const QIcon& icon, const QString& name);
+
+  /// Adds/removes the items of many paints at once (adding uses the icon and name of each paint).
+  void addPaintItems(const QVector<uid>& paintIds);
+  void removePaintItems(const QVector<uid>& paintIds);
   void updatePaintItem(uid paintId, const QIcon& icon, const QString& name);
   void removePaintItem(uid paintId);
   void renameMapping(uid mappingId, const QString& name);
@@ -340,6 +397,9 @@ private:
   static int getItemRowFromId(const QListWidget& list, uid id);
   uid currentMappingItemId() const;
 
+  // Returns the ids of all selected mappings (in list order).
+  QVector<uid> selectedMappingIds() const;
+
   static QIcon createColorIcon(const QColor& color);
   static QIcon createFileIcon(const QString& filename);
   static QIcon createImageIcon(const QString& filename);
@@ -407,6 +467,9 @@ private:
   QAction *rewindAction;
 
   QAction *outputFullScreenAction;
+  QAction *spanOutputAction;
+  QAction *recordOutputAction;
+  QAction *outputCorrectionAction;
   QAction *displayControlsAction;
   QAction *displayPaintControlsAction;
   QAction *displayTestSignalAction;
@@ -466,6 +529,23 @@ private:
   OutputGLWindow* outputWindow;
   ConsoleWindow* consoleWindow;
 
+  // Additional output windows, each displaying a region of the composition.
+  QList<OutputGLWindow*> extraOutputWindows;
+
+  // Screen of the main output before it was spanned across screens (-1 if not spanned).
+  int _unspannedOutputScreen;
+
+  // Warp and edge blend of each output (indexed like getOutputWindows(), saved in project).
+  QList<OutputCorrection::ptr> outputCorrections;
+
+  // Renders the output composition once per frame for all output windows and destination canvas.
+  Compositor* compositor;
+
+  // Reads back composed frames asynchronously for recording and publishing.
+  FrameReader* frameReader;
+  VideoRecorder* videoRecorder;
+  SharedMemoryOutput* sharedMemoryOutput;
+
   QSplitter* mainSplitter;
   QSplitter* canvasSplitter;
 
@@ -511,6 +591,9 @@ private:
   // Number of frames per second.
   qreal _framesPerSecond;
 
+  // True iff something changed and canvases need to be redrawn at next frame.
+  bool _canvasesNeedUpdate;
+
   // True iff the play button is currently pressed.
   bool _isPlaying;
 
@@ -531,10 +614,12 @@ private:
   // Keeps track of the current selected item, wether it's a paint or mapping.
   QListWidgetItem* currentSelectedItem;
   QModelIndex currentSelectedIndex;
-  QTimer *videoTimer;
+  FrameClock *frameClock;
   QElapsedTimer *systemTimer;
   // Preference dialog
   PreferenceDialog* _preferenceDialog;
+  // Output correction dialog
+  OutputCorrectionDialog* _outputCorrectionDialog;
   // About dialog
   AboutDialog *_aboutDialog;
 
@@ -570,8 +655,30 @@ public:
   void removeCurrentMapping();
 
   OutputGLWindow* getOutputWindow() const { return outputWindow; }
+
+  /// Returns all output windows (main output window first).
+  QList<OutputGLWindow*> getOutputWindows() const { return QList<OutputGLWindow*>() << outputWindow << extraOutputWindows; }
+
+  /// Adds an output window displaying region of the composition on given screen.
+  OutputGLWindow* addOutputWindow(int screen, const QRect& region);
+
+  /// Removes all output windows except the main one.
+  void removeExtraOutputWindows();
+
+  /// Returns the correction (warp and edge blend) of given output, creating it if needed.
+  OutputCorrection::ptr getOutputCorrection(int output);
+
+  /// Replaces the correction of given output.
+  void setOutputCorrection(int output, OutputCorrection::ptr correction);
+
+  /// Returns the number of output corrections (some of which may leave their output unchanged).
+  int nOutputCorrections() const { return outputCorrections.size(); }
+
+  /// Removes the corrections of all outputs.
+  void clearOutputCorrections();
   MapperGLCanvas* getSourceCanvas() const { return sourceCanvas; }
   MapperGLCanvas* getDestinationCanvas() const { return destinationCanvas; }
+  FrameClock* getFrameClock() const { return frameClock; }
   int getPreferredScreen() const { return outputWindow->getPreferredScreen(); }
 
   /// Returns the number of frames per second.
@@ -598,6 +705,15 @@ public:
   int getOscPort() const;
   void setOutputWindowFullScreen(bool enable);
 
+  /// Sets whether the output is rendered natively from the mappings (see NativeRenderer).
+  void setNativeOutputRendering(bool native);
+
+  /// Sets the internal render resolution relative to output resolution (see Compositor).
+  void setRenderScale(qreal scale);
+
+  /// Starts or stops publishing the composition to shared memory at given socket path (see SharedMemoryOutput).
+  void setSharedMemoryOutput(bool enabled, const QString& socketPath);
+
 public:
   // Constants. ///////////////////////////////////////////////////////////////////////////////////////
   static const int DEFAULT_WIDTH = 1360;
@@ -24,12 +24,14 @@
 
 #include "MainWindow.h"
 #include "Commands.h"
+#include "Compositor.h"
+#include "BatchRenderer.h"
 
 namespace mmp {
 
 MapperGLCanvas::MapperGLCanvas(MainWindow* mainWindow,
                                bool isOutput, QWidget* parent, const QGLWidget * shareWidget,
-                               QGraphicsScene* scene)
+                               QGraphicsScene* scene, int swapInterval, bool multisample)
   : QGraphicsView(parent),
     _mainWindow(mainWindow),
     _isOutput(isOutput),
@@ -39,7 +41,9 @@ MapperGLCanvas::MapperGLCanvas(MainWindow* mainWindow,
     _shapeGrabbed(false), // comment out?
     _shapeFirstGrab(false), // comment out?
     _zoomLevel(0),
-    _shapeIsAdapted(false)
+    _shapeIsAdapted(false),
+    _compositor(NULL),
+    _spatialIndex(isOutput)
 {
   // For now clicking on the window doesn't do anything.
   setDragMode(QGraphicsView::NoDrag);
@@ -66,7 +70,10 @@ MapperGLCanvas::MapperGLCanvas(MainWindow* mainWindow,
   // setAcceptDrops(true);
 
   // Render with OpenGL.
-  setViewport(new QGLWidget(QGLFormat(QGL::SampleBuffers), this, shareWidget));
+  QGLFormat format;
+  format.setSampleBuffers(multisample);
+  format.setSwapInterval(swapInterval);
+  setViewport(new QGLWidget(format, this, shareWidget));
   setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
 
   // TODO: do we need to delete scene (or call new QGraphicsScene(this)?)
@@ -275,60 +282,45 @@ void MapperGLCanvas::mousePressEvent(QMouseEvent* event)
     {
       if (selectedShape)
       {
-        // Note: we compare with the square value for fastest computation of the distance
-        int minDistance = sq(MM::VERTEX_SELECT_RADIUS);
-
         _grabbedShapeStartCenterScenePosition = selectedShape->getCenter();
         _grabbedShapeCopy.reset(selectedShape->clone());
 
         // Find the ID of the nearest vertex (from currently selected shape)
-        for (int i = 0; i < selectedShape->nVertices(); i++)
+        // NOTE: select radius is expressed in pixels on screen.
+        int vertex = _spatialIndex.findVertex(pos, MM::VERTEX_SELECT_RADIUS / transform().m11(), selectedShape);
+        if (vertex != NO_VERTEX)
         {
-          int dist = distSq(_mousePressedPosition, mapFromScene(selectedShape->getVertex(i))); // squared distance
-          if (dist < minDistance)
-          {
-            _activeVertex = i;
-            minDistance = dist;
+          _activeVertex = vertex;
 
-            // Vertex can be grabbed only if the mapping is not locked
-            _vertexGrabbed = !selectedShape->isLocked();
-            _vertexMoved = false; // Active vertex may not moved
-            mousePressedOnSomething = true;
+          // Vertex can be grabbed only if the mapping is not locked
+          _vertexGrabbed = !selectedShape->isLocked();
+          _vertexMoved = false; // Active vertex may not moved
+          mousePressedOnSomething = true;
 
-            _grabbedObjectStartScenePosition = selectedShape->getVertex(i);
-          }
+          _grabbedObjectStartScenePosition = selectedShape->getVertex(vertex);
         }
       }
     }
 
-    // Possibility of changing shape in output by clicking on it.
-    MappingManager manager = getMainWindow()->getMappingManager();
-    QVector<Mapping::ptr> mappings = manager.getVisibleMappings();
-    for (QVector<Mapping::ptr>::const_iterator it = mappings.end() - 1;
-         it >= mappings.begin(); --it)
+    // Possibility of changing shape in output by clicking on it (topmost visible shape under mouse).
+    Mapping::ptr clickedMapping = (_vertexGrabbed ? Mapping::ptr() : _spatialIndex.getMappingAt(pos));
+    if (clickedMapping)
     {
-      MShape::ptr shape = getShapeFromMapping(*it);
-
-      // Check if mouse was pressed on that shape.
-      if (shape && !_vertexGrabbed && shape->includesPoint(pos))
-      {
-        mousePressedOnSomething = true;
-
-        // Deselect vertices.
-        deselectVertices();
+      MShape::ptr shape = getShapeFromMapping(clickedMapping);
+      mousePressedOnSomething = true;
 
-        // Change mapping (only available in destination).
-        if (isOutput() && shape != selectedShape)
-        {
-          // Change current mapping.
-          getMainWindow()->setCurrentMapping((*it)->getId());
+      // Deselect vertices.
+      deselectVertices();
 
-          // Reset selected shape to new one.
-          selectedShape = getCurrentShape();
-          shapeSelectionChange = true;
-        }
+      // Change mapping (only available in destination).
+      if (isOutput() && shape != selectedShape)
+      {
+        // Change current mapping.
+        getMainWindow()->setCurrentMapping(clickedMapping->getId());
 
-        break; // Exit loop
+        // Reset selected shape to new one.
+        selectedShape = getCurrentShape();
+        shapeSelectionChange = true;
       }
     }
 
@@ -684,6 +676,34 @@ void MapperGLCanvas::updateCanvas()
   scene()->update();
 }
 
+void MapperGLCanvas::setCompositor(Compositor* compositor)
+{
+  _compositor = compositor;
+
+  // Items need to go through drawItems() so that they can be skipped.
+  setOptimizationFlag(QGraphicsView::IndirectPainting, _compositor != NULL);
+}
+
+bool MapperGLCanvas::_usesComposition() const
+{
+  return (_compositor && _compositor->isValid());
+}
+
+void MapperGLCanvas::drawBackground(QPainter *painter, const QRectF &rect)
+{
+  QGraphicsView::drawBackground(painter, rect);
+
+  if (_usesComposition())
+    _compositor->draw(painter, _compositor->getSceneRect());
+}
+
+void MapperGLCanvas::drawItems(QPainter *painter, int numItems, QGraphicsItem *items[], const QStyleOptionGraphicsItem options[])
+{
+  // Items were already rendered by the compositor.
+  if (!_usesComposition())
+    BatchRenderer::drawItems(painter, numItems, items, options, viewport());
+}
+
 void MapperGLCanvas::deselectVertices()
 {
   _activeVertex = NO_VERTEX;
@@ -840,24 +860,11 @@ void MapperGLCanvas::_snapVertex(QPointF* p)
 {
   QSettings settings;
   int vertexStickRadius = settings.value("vertexStickRadius", MM::VERTEX_STICK_RADIUS).toInt();
-  MappingManager manager = MainWindow::window()->getMappingManager();
-  MShape::ptr currentShape = getCurrentShape();
-  for (int i = 0; i < manager.nMappings(); i++)
-  {
-    MShape::ptr shape = getShapeFromMapping(manager.getMapping(i));
-    if (shape && shape != currentShape)
-    {
-      for (int vertex = 0; vertex < shape->nVertices(); vertex++)
-      {
-        const QPointF& v = shape->getVertex(vertex);
-        if (distIsInside(v, *p, vertexStickRadius))
-        {
-          p->setX(v.x());
-          p->setY(v.y());
-        }
-      }
-    }
-  }
+
+  // Stick to the closest vertex of other shapes.
+  QPointF vertex;
+  if (_spatialIndex.findNearestVertex(*p, vertexStickRadius, &vertex, getCurrentShape()))
+    *p = vertex;
 }
 
 }
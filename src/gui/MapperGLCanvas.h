@@ -37,11 +37,13 @@
 #include "Shape.h"
 
 #include "MappingGui.h"
+#include "ShapeSpatialIndex.h"
 
 namespace mmp {
 
 class MainWindow;
 class ShapeGraphicsItem;
+class Compositor;
 
 /**
  * Mother class for OpenGL canvases that allow the display and controls of shapes and vertices.
@@ -51,8 +53,12 @@ class MapperGLCanvas: public QGraphicsView
 {
   Q_OBJECT
 public:
-  /// Constructor.
-  MapperGLCanvas(MainWindow* mainWindow, bool isOutput, QWidget* parent = 0, const QGLWidget* shareWidget = 0, QGraphicsScene* scene = 0);
+  /**
+   * Constructor. By default buffer swaps are not synced to vertical refresh (see swapInterval).
+   * Canvases that only display the (already antialiased) composition can do without multisampling.
+   */
+  MapperGLCanvas(MainWindow* mainWindow, bool isOutput, QWidget* parent = 0, const QGLWidget* shareWidget = 0, QGraphicsScene* scene = 0,
+                 int swapInterval = 0, bool multisample = true);
   virtual ~MapperGLCanvas() {}
 
   /// Returns shape associated with mapping id.
@@ -100,7 +106,25 @@ public:
   // Apply zoom to view
   void applyZoomToView();
 
+  /**
+   * Sets the compositor whose rendered frame replaces the drawing of the scene items
+   * (controls are still drawn on top). Set to NULL to draw the items directly.
+   */
+  void setCompositor(Compositor* compositor);
+
+  /// Returns the compositor (NULL if none).
+  Compositor* getCompositor() const { return _compositor; }
+
 protected:
+  // Draws the composition (if any) over the background.
+  void drawBackground(QPainter *painter, const QRectF &rect);
+
+  // Only draws the items if there is no valid composition to draw instead.
+  void drawItems(QPainter *painter, int numItems, QGraphicsItem *items[], const QStyleOptionGraphicsItem options[]);
+
+  /// Returns true iff the canvas draws the compositor frame instead of the items.
+  bool _usesComposition() const;
+
 //  void initializeGL();
 //  void resizeGL(int width, int height);
 //  void paintGL();
@@ -177,6 +201,12 @@ private:
   // Pointer to MainWindow UndoStack
   QUndoStack *undoStack;
 
+  // Shared composition (can be NULL).
+  Compositor* _compositor;
+
+  // Index of shapes and vertices for hit-testing and snapping.
+  ShapeSpatialIndex _spatialIndex;
+
 signals:
   void shapeChanged(MShape*);
   void imageChanged();
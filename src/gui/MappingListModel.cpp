@@ -114,15 +114,17 @@ QMimeData *MappingListModel::mimeData(const QModelIndexList &indexes) const
   QByteArray encodeData;
   QDataStream stream(&encodeData, QIODevice::WriteOnly);
 
+  // Take one index per row, in row order.
+  QMap<int, int> rowIds;
   for (QModelIndex index: indexes) {
     if (index.isValid()) {
       if (index.column() == MM::HideColumn) {
-        int id = data(index, Qt::UserRole).toInt();
-        stream << id;
-        break; // Just take a first index and go
+        rowIds[index.row()] = data(index, Qt::UserRole).toInt();
       }
     }
   }
+  foreach (int id, rowIds)
+    stream << id;
 
   mimeData->setData(MIMETYPE, encodeData);
 
@@ -157,12 +159,26 @@ bool MappingListModel::dropMimeData(const QMimeData *data, Qt::DropAction action
     stream >> id;
 
     int rows = getItemRowFromId(id);
+    if (rows < 0)
+      continue;
+
+    // Item already in place: next one goes after it.
+    if (rows == endRow || rows + 1 == endRow) {
+      endRow = rows + 1;
+      continue;
+    }
+
     if (!beginMoveRows(QModelIndex(), rows, rows, QModelIndex(), endRow))
       continue;
-    mappingList.move(rows, endRow);
+    if (rows < endRow) {
+      // Moving down: rows below shift up once the item is taken out.
+      mappingList.move(rows, endRow - 1);
+    }
+    else {
+      mappingList.move(rows, endRow);
+      ++endRow;
+    }
     endMoveRows();
-
-    ++endRow;
   }
 
   return true;
@@ -227,6 +243,39 @@ void MappingListModel::addItem(Mapping::ptr mapping, const QIcon &icon, const QS
   mappingList.insert(0, item);
 }
 
+int MappingListModel::removeItems(const QSet<uid> &ids)
+{
+  int firstRow = -1;
+  int n = 0;
+  for (int row = 0; row < mappingList.size(); row++) {
+    if (ids.contains(mappingList.at(row).id)) {
+      if (firstRow < 0)
+        firstRow = row;
+    }
+    else
+      mappingList[n++] = mappingList.at(row);
+  }
+  mappingList.erase(mappingList.begin() + n, mappingList.end());
+  return firstRow;
+}
+
+void MappingListModel::reorderItems(const QVector<uid> &ids)
+{
+  QHash<uid, MappingItem> items;
+  foreach (const MappingItem& item, mappingList)
+    items[item.id] = item;
+
+  mappingList.clear();
+  for (int i = ids.size() - 1; i >= 0; i--) {
+    if (items.contains(ids[i]))
+      mappingList.append(items.take(ids[i]));
+  }
+
+  // Items not given keep their place on top.
+  foreach (const MappingItem& item, items)
+    mappingList.insert(0, item);
+}
+
 void MappingListModel::updateModel()
 {
   beginResetModel();
@@ -235,10 +284,8 @@ void MappingListModel::updateModel()
 
 void MappingListModel::clear()
 {
-  for (auto it = mappingList.end() - 1; it >= mappingList.begin(); --it) {
-    mappingList.erase(it);
-    updateModel();
-  }
+  mappingList.clear();
+  updateModel();
 }
 
 QModelIndex MappingListModel::getIndexFromRow(int row)
@@ -22,6 +22,9 @@
 
 #include <QAbstractTableModel>
 #include <QList>
+#include <QSet>
+#include <QHash>
+#include <QMap>
 #include <QIcon>
 #include <QDebug>
 #include <QMimeData>
@@ -58,6 +61,12 @@ public:
   void removeItem(int index);
   void addItem(Mapping::ptr mapping, const QIcon &icon, const QString &label);
 
+  /// Removes items of given ids (in a single pass) and returns the smallest row removed (-1 if none).
+  int removeItems(const QSet<uid> &ids);
+
+  /// Orders items like the given layer ids (bottom layer first, ie. last row first).
+  void reorderItems(const QVector<uid> &ids);
+
   void updateModel();
   void clear();
 
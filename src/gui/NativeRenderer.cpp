@@ -0,0 +1,155 @@
+/*
+ * NativeRenderer.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NativeRenderer.h"
+
+#include "MainWindow.h"
+#include "ShapeGraphicsItem.h"
+
+namespace mmp {
+
+void GLStateCache::invalidate()
+{
+  _blending = _texturing = UNKNOWN;
+  _boundTexture = 0;
+  _boundTextureKnown = false;
+}
+
+void GLStateCache::setBlending(bool enabled)
+{
+  if (_blending != (int)enabled)
+  {
+    if (enabled)
+    {
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    else
+      glDisable(GL_BLEND);
+    _blending = enabled;
+  }
+}
+
+void GLStateCache::setTexturing(bool enabled)
+{
+  if (_texturing != (int)enabled)
+  {
+    if (enabled)
+      glEnable(GL_TEXTURE_2D);
+    else
+      glDisable(GL_TEXTURE_2D);
+    _texturing = enabled;
+  }
+}
+
+void GLStateCache::bindTexture(GLuint textureId)
+{
+  if (!_boundTextureKnown || _boundTexture != textureId)
+  {
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    _boundTexture = textureId;
+    _boundTextureKnown = true;
+  }
+}
+
+void NativeRenderer::render(QPainter* painter, const MappingManager& manager)
+{
+  MainWindow* win = MainWindow::window();
+
+  painter->beginNativePainting();
+
+  // QPainter may have changed anything since last frame.
+  _state.invalidate();
+  _preparedTextures.clear();
+
+  _state.setBlending(true);
+
+  QVector<Mapping::ptr> mappings = manager.getVisibleMappings();
+  for (QVector<Mapping::ptr>::const_iterator it = mappings.begin(); it != mappings.end(); ++it)
+  {
+    MappingGui::ptr mappingGui = win->getMappingGuiByMappingId((*it)->getId());
+    if (mappingGui.isNull())
+      continue;
+
+    ShapeGraphicsItem::ptr item = mappingGui->getGraphicsItem();
+
+    // Keep depth of figure in sync with that of mapping (used by the editor).
+    item->setZValue((*it)->getDepth());
+
+    if (TextureGraphicsItem* textureItem = dynamic_cast<TextureGraphicsItem*>(item.data()))
+    {
+      QSharedPointer<Texture> texture = textureItem->getTexture();
+      if (texture != _texture || !_colorBatch.isEmpty())
+      {
+        _flush();
+        _texture = texture;
+      }
+      textureItem->appendGeometry(_textureBatch);
+    }
+    else if (ColorGraphicsItem* colorItem = dynamic_cast<ColorGraphicsItem*>(item.data()))
+    {
+      if (!_textureBatch.isEmpty())
+        _flush();
+      colorItem->appendGeometry(_colorBatch);
+    }
+  }
+  _flush();
+
+  _state.setTexturing(false);
+
+  painter->endNativePainting();
+}
+
+void NativeRenderer::_flush()
+{
+  if (!_textureBatch.isEmpty())
+  {
+    _prepareTexture(_texture);
+    _textureBatch.draw();
+    _textureBatch.clear();
+  }
+  _texture.clear();
+
+  if (!_colorBatch.isEmpty())
+  {
+    _state.setTexturing(false);
+    _colorBatch.draw();
+    _colorBatch.clear();
+  }
+}
+
+void NativeRenderer::_prepareTexture(const QSharedPointer<Texture>& texture)
+{
+  bool firstUse = !_preparedTextures.contains(texture.data());
+
+  // Texture id is only available after first update.
+  if (firstUse)
+    texture->update();
+
+  _state.setTexturing(true);
+  _state.bindTexture(texture->getTextureId());
+
+  if (firstUse)
+  {
+    TextureGraphicsItem::uploadTexture(texture);
+    _preparedTextures.insert(texture.data());
+  }
+}
+
+}
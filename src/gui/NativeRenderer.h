@@ -0,0 +1,104 @@
+/*
+ * NativeRenderer.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NATIVE_RENDERER_H_
+#define NATIVE_RENDERER_H_
+
+#include <QtGlobal>
+
+#if __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <QPainter>
+#include <QSet>
+
+#include "BatchRenderer.h"
+#include "MappingManager.h"
+
+namespace mmp {
+
+/**
+ * Keeps track of the GL state set by the native renderer so that each state
+ * change is only issued when it actually changes something.
+ */
+class GLStateCache
+{
+public:
+  GLStateCache() { invalidate(); }
+
+  /// Forgets the current state (eg. after someone else issued GL calls).
+  void invalidate();
+
+  /// Enables or disables alpha blending.
+  void setBlending(bool enabled);
+
+  /// Enables or disables 2D texturing.
+  void setTexturing(bool enabled);
+
+  /// Binds 2D texture.
+  void bindTexture(GLuint textureId);
+
+private:
+  enum { UNKNOWN = -1 };
+
+  int _blending;
+  int _texturing;
+  GLuint _boundTexture;
+  bool _boundTextureKnown;
+};
+
+/**
+ * Renders the output composition straight from the visible mappings of a
+ * MappingManager (in depth order) using GL calls, without going through
+ * QGraphicsScene and QPainter for each item. Consecutive mappings sharing a
+ * texture (or consecutive color mappings) are drawn with one call, textures are
+ * updated once per frame and GL state is only changed when needed.
+ */
+class NativeRenderer
+{
+public:
+  NativeRenderer() {}
+
+  /// Renders the visible mappings of manager (painter must be in scene coordinates).
+  void render(QPainter* painter, const MappingManager& manager);
+
+private:
+  // Draws and clears the current batch.
+  void _flush();
+
+  // Updates and binds texture (updates only happen once per frame).
+  void _prepareTexture(const QSharedPointer<Texture>& texture);
+
+  GLStateCache _state;
+
+  // Texture of the current texture batch.
+  QSharedPointer<Texture> _texture;
+  TextureBatch _textureBatch;
+  ColorBatch _colorBatch;
+
+  // Textures already updated this frame.
+  QSet<Texture*> _preparedTextures;
+};
+
+}
+
+#endif /* NATIVE_RENDERER_H_ */
@@ -0,0 +1,195 @@
+/*
+ * OutputCorrectionDialog.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OutputCorrectionDialog.h"
+
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+namespace mmp {
+
+// Creates a spin box editing a blend width in percent of the output.
+static QDoubleSpinBox* createBlendBox()
+{
+  QDoubleSpinBox* box = new QDoubleSpinBox;
+  box->setRange(0, 50);
+  box->setDecimals(1);
+  box->setSingleStep(1);
+  box->setSuffix(" %");
+  return box;
+}
+
+OutputCorrectionDialog::OutputCorrectionDialog(QWidget* parent) :
+    QDialog(parent),
+    _output(-1),
+    _loading(false)
+{
+  setWindowTitle(tr("Output Correction"));
+
+  // Output selector.
+  _outputBox = new QComboBox;
+
+  // Edge blend.
+  _blendLeftBox   = createBlendBox();
+  _blendRightBox  = createBlendBox();
+  _blendTopBox    = createBlendBox();
+  _blendBottomBox = createBlendBox();
+
+  _blendGammaBox = new QDoubleSpinBox;
+  _blendGammaBox->setRange(0.1, 5.0);
+  _blendGammaBox->setDecimals(2);
+  _blendGammaBox->setSingleStep(0.1);
+
+  QGroupBox* blendGroup = new QGroupBox(tr("Edge blend"));
+  QFormLayout* blendLayout = new QFormLayout;
+  blendLayout->addRow(tr("Left"),   _blendLeftBox);
+  blendLayout->addRow(tr("Right"),  _blendRightBox);
+  blendLayout->addRow(tr("Top"),    _blendTopBox);
+  blendLayout->addRow(tr("Bottom"), _blendBottomBox);
+  blendLayout->addRow(tr("Gamma"),  _blendGammaBox);
+  blendGroup->setLayout(blendLayout);
+
+  // Warp.
+  _warpColumnsBox = new QSpinBox;
+  _warpColumnsBox->setRange(1, MM::OUTPUT_CORRECTION_MAX_WARP_SIZE);
+  _warpRowsBox = new QSpinBox;
+  _warpRowsBox->setRange(1, MM::OUTPUT_CORRECTION_MAX_WARP_SIZE);
+  _resetWarpButton = new QPushButton(tr("Reset warp"));
+  _editWarpBox = new QCheckBox(tr("Edit warp on output"));
+
+  QGroupBox* warpGroup = new QGroupBox(tr("Warp"));
+  QFormLayout* warpLayout = new QFormLayout;
+  warpLayout->addRow(tr("Columns"), _warpColumnsBox);
+  warpLayout->addRow(tr("Rows"),    _warpRowsBox);
+  warpLayout->addRow(_resetWarpButton);
+  warpLayout->addRow(_editWarpBox);
+  warpGroup->setLayout(warpLayout);
+
+  QFormLayout* outputLayout = new QFormLayout;
+  outputLayout->addRow(tr("Output"), _outputBox);
+
+  QVBoxLayout* mainLayout = new QVBoxLayout;
+  mainLayout->addLayout(outputLayout);
+  mainLayout->addWidget(blendGroup);
+  mainLayout->addWidget(warpGroup);
+  setLayout(mainLayout);
+
+  connect(_outputBox, SIGNAL(currentIndexChanged(int)), this, SLOT(loadCorrection()));
+  connect(_blendLeftBox,   SIGNAL(valueChanged(double)), this, SLOT(applyBlend()));
+  connect(_blendRightBox,  SIGNAL(valueChanged(double)), this, SLOT(applyBlend()));
+  connect(_blendTopBox,    SIGNAL(valueChanged(double)), this, SLOT(applyBlend()));
+  connect(_blendBottomBox, SIGNAL(valueChanged(double)), this, SLOT(applyBlend()));
+  connect(_blendGammaBox,  SIGNAL(valueChanged(double)), this, SLOT(applyBlend()));
+  connect(_resetWarpButton, SIGNAL(clicked()), this, SLOT(resetWarp()));
+  connect(_editWarpBox, SIGNAL(toggled(bool)), this, SLOT(setEditingWarp(bool)));
+}
+
+void OutputCorrectionDialog::showEvent(QShowEvent* event)
+{
+  // Outputs may have been added since last time.
+  _loading = true;
+  _outputBox->clear();
+  int nOutputs = MainWindow::window()->getOutputWindows().size();
+  for (int i=0; i<nOutputs; i++)
+    _outputBox->addItem(tr("Output %1").arg(i+1));
+  _loading = false;
+
+  loadCorrection();
+  QDialog::showEvent(event);
+}
+
+void OutputCorrectionDialog::hideEvent(QHideEvent* event)
+{
+  _editWarpBox->setChecked(false);
+  QDialog::hideEvent(event);
+}
+
+void OutputCorrectionDialog::loadCorrection()
+{
+  if (_loading)
+    return;
+
+  // Stop editing the warp of previous output.
+  if (OutputGLWindow* previousWindow = _currentWindow())
+    previousWindow->setEditingWarp(false);
+
+  _output = _outputBox->currentIndex();
+  if (_output < 0)
+    return;
+
+  OutputCorrection::ptr correction = MainWindow::window()->getOutputCorrection(_output);
+
+  _loading = true;
+  _blendLeftBox->setValue(correction->getBlendLeft() * 100);
+  _blendRightBox->setValue(correction->getBlendRight() * 100);
+  _blendTopBox->setValue(correction->getBlendTop() * 100);
+  _blendBottomBox->setValue(correction->getBlendBottom() * 100);
+  _blendGammaBox->setValue(correction->getBlendGamma());
+  _warpColumnsBox->setValue(correction->getWarpColumns());
+  _warpRowsBox->setValue(correction->getWarpRows());
+  _loading = false;
+
+  // Keep editing if requested.
+  setEditingWarp(_editWarpBox->isChecked());
+}
+
+void OutputCorrectionDialog::applyBlend()
+{
+  if (_loading || _output < 0)
+    return;
+
+  OutputCorrection::ptr correction = MainWindow::window()->getOutputCorrection(_output);
+  correction->setBlendLeft(_blendLeftBox->value() / 100);
+  correction->setBlendRight(_blendRightBox->value() / 100);
+  correction->setBlendTop(_blendTopBox->value() / 100);
+  correction->setBlendBottom(_blendBottomBox->value() / 100);
+  correction->setBlendGamma(_blendGammaBox->value());
+  _correctionChanged();
+}
+
+void OutputCorrectionDialog::resetWarp()
+{
+  if (_output < 0)
+    return;
+
+  MainWindow::window()->getOutputCorrection(_output)->resetWarp(_warpColumnsBox->value(), _warpRowsBox->value());
+  _correctionChanged();
+}
+
+void OutputCorrectionDialog::setEditingWarp(bool editing)
+{
+  if (OutputGLWindow* window = _currentWindow())
+    window->setEditingWarp(editing);
+}
+
+OutputGLWindow* OutputCorrectionDialog::_currentWindow() const
+{
+  QList<OutputGLWindow*> windows = MainWindow::window()->getOutputWindows();
+  return (0 <= _output && _output < windows.size() ? windows[_output] : NULL);
+}
+
+void OutputCorrectionDialog::_correctionChanged()
+{
+  MainWindow::window()->windowModified();
+  MainWindow::window()->updateCanvases();
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * OutputCorrectionDialog.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUT_CORRECTION_DIALOG_H_
+#define OUTPUT_CORRECTION_DIALOG_H_
+
+#include <QDialog>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QPushButton>
+#include <QSpinBox>
+
+#include "MainWindow.h"
+
+namespace mmp {
+
+/**
+ * Edits the warp and edge blend of each output. Changes are applied live.
+ */
+class OutputCorrectionDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  OutputCorrectionDialog(QWidget* parent = 0);
+
+protected:
+  void showEvent(QShowEvent* event);
+  void hideEvent(QHideEvent* event);
+
+private slots:
+  // Refreshes widgets with the correction of the selected output.
+  void loadCorrection();
+
+  // Applies blend widgets to the correction of the selected output.
+  void applyBlend();
+
+  // Resets warp of the selected output to a grid of the chosen size.
+  void resetWarp();
+
+  // Toggles warp editing on the selected output.
+  void setEditingWarp(bool editing);
+
+private:
+  // Returns the window of the selected output (NULL if none).
+  OutputGLWindow* _currentWindow() const;
+
+  // Updates output canvases after a change.
+  void _correctionChanged();
+
+  QComboBox* _outputBox;
+
+  QDoubleSpinBox* _blendLeftBox;
+  QDoubleSpinBox* _blendRightBox;
+  QDoubleSpinBox* _blendTopBox;
+  QDoubleSpinBox* _blendBottomBox;
+  QDoubleSpinBox* _blendGammaBox;
+
+  QSpinBox* _warpColumnsBox;
+  QSpinBox* _warpRowsBox;
+  QPushButton* _resetWarpButton;
+  QCheckBox* _editWarpBox;
+
+  // Index of the output being edited.
+  int _output;
+  bool _loading;
+};
+
+}
+
+#endif /* OUTPUT_CORRECTION_DIALOG_H_ */
@@ -21,14 +21,50 @@
 
 #include "OutputGLCanvas.h"
 #include "MainWindow.h"
+#include "Commands.h"
 
 namespace mmp {
 
+// Samples the composition and applies the edge-blend ramps in output (viewport) space.
+static const char* CORRECTION_VERTEX_SHADER =
+    "#version 120\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "  gl_Position = ftransform();\n"
+    "  texCoord = gl_MultiTexCoord0.xy;\n"
+    "}\n";
+
+static const char* CORRECTION_FRAGMENT_SHADER =
+    "#version 120\n"
+    "uniform sampler2D frame;\n"
+    "uniform vec2 viewportSize;\n"
+    "uniform vec4 blend;\n" // left, right, top, bottom
+    "uniform float gamma;\n"
+    "varying vec2 texCoord;\n"
+    "float ramp(float d, float width) {\n"
+    "  return (width > 0.0 ? pow(clamp(d / width, 0.0, 1.0), 1.0 / gamma) : 1.0);\n"
+    "}\n"
+    "void main() {\n"
+    "  vec2 p = gl_FragCoord.xy / viewportSize;\n" // origin is bottom-left
+    "  float mask = ramp(p.x, blend.x) * ramp(1.0 - p.x, blend.y) * ramp(1.0 - p.y, blend.z) * ramp(p.y, blend.w);\n"
+    "  gl_FragColor = vec4(texture2D(frame, texCoord).rgb * mask, 1.0);\n"
+    "}\n";
+
 OutputGLCanvas::OutputGLCanvas(MainWindow* mainWindow, QWidget* parent, const QGLWidget* shareWidget, QGraphicsScene* scene)
-: MapperGLCanvas(mainWindow, true, parent, shareWidget, scene),
+: MapperGLCanvas(mainWindow, true, parent, shareWidget, scene,
+                 1,      // synced to vertical refresh
+                 false), // composition is antialiased when rendered
   _displayCrosshair(false),
   _displayTestSignal(false),
-  _windowIsHovered(false)
+  _testCardTexture(0),
+  _testCardType(-1),
+  _testCardShowsResolution(false),
+  _windowIsHovered(false),
+  _correction(new OutputCorrection),
+  _correctionProgram(NULL),
+  _editingWarp(false),
+  _grabbedWarpColumn(-1),
+  _grabbedWarpRow(-1)
 {
   // Disable scrollbars.
   setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
@@ -37,9 +73,169 @@ OutputGLCanvas::OutputGLCanvas(MainWindow* mainWindow, QWidget* parent, const QG
   setSceneRectToViewportGeometry();
 }
 
+OutputGLCanvas::~OutputGLCanvas()
+{
+  if (_testCardTexture)
+    static_cast<QGLWidget*>(viewport())->deleteTexture(_testCardTexture);
+  delete _correctionProgram;
+}
+
+void OutputGLCanvas::setCorrection(OutputCorrection::ptr correction)
+{
+  _correction = correction;
+  update();
+}
+
+void OutputGLCanvas::setEditingWarp(bool editing)
+{
+  _editingWarp = editing;
+  _grabbedWarpColumn = _grabbedWarpRow = -1;
+  update();
+}
+
+void OutputGLCanvas::drawBackground(QPainter *painter, const QRectF &rect)
+{
+  if (_usesComposition() && !_correction->isIdentity())
+  {
+    QGraphicsView::drawBackground(painter, rect);
+    _drawCorrectedComposition(painter);
+  }
+  else
+    MapperGLCanvas::drawBackground(painter, rect);
+}
+
+QPointF OutputGLCanvas::_fromNormalized(const QPointF& point) const
+{
+  return QPointF(point.x() * viewport()->width(), point.y() * viewport()->height());
+}
+
+void OutputGLCanvas::_drawCorrectedComposition(QPainter* painter)
+{
+  // Lazily build shader (needs current context).
+  if (!_correctionProgram)
+  {
+    _correctionProgram = new QGLShaderProgram(static_cast<QGLWidget*>(viewport())->context());
+    _correctionProgram->addShaderFromSourceCode(QGLShader::Vertex,   CORRECTION_VERTEX_SHADER);
+    _correctionProgram->addShaderFromSourceCode(QGLShader::Fragment, CORRECTION_FRAGMENT_SHADER);
+    if (!_correctionProgram->link())
+      qWarning() << "Could not link output correction shader: " << _correctionProgram->log() << endl;
+  }
+
+  // Region of the composition displayed by this output, and where it lies in the composition texture.
+  QRectF outputRect      = sceneRect();
+  QRectF compositionRect = getCompositor()->getSceneRect();
+
+  // Subdivide each warp cell so that the bilinear warp looks smooth.
+  const int subdivisions = 8;
+  int nColumns = _correction->getWarpColumns() * subdivisions;
+  int nRows    = _correction->getWarpRows()    * subdivisions;
+
+  QVector<GLfloat> vertices;
+  QVector<GLfloat> texCoords;
+  vertices.reserve(nColumns*nRows*12);
+  texCoords.reserve(nColumns*nRows*12);
+  static const int corners[6][2] = { {0,0}, {1,0}, {1,1}, {0,0}, {1,1}, {0,1} };
+  for (int row=0; row<nRows; row++)
+  {
+    for (int column=0; column<nColumns; column++)
+    {
+      for (int i=0; i<6; i++)
+      {
+        QPointF uv(qreal(column + corners[i][0]) / nColumns, qreal(row + corners[i][1]) / nRows);
+
+        QPointF position = _fromNormalized(_correction->mapWarp(uv));
+        vertices << position.x() << position.y();
+
+        // Framebuffer textures are stored bottom-up.
+        QPointF scenePoint(outputRect.x() + uv.x()*outputRect.width(), outputRect.y() + uv.y()*outputRect.height());
+        texCoords << (scenePoint.x() - compositionRect.x()) / compositionRect.width()
+                  << 1 - (scenePoint.y() - compositionRect.y()) / compositionRect.height();
+      }
+    }
+  }
+
+  // Draw in viewport coordinates.
+  painter->save();
+  painter->resetTransform();
+  painter->beginNativePainting();
+
+  glDisable(GL_BLEND);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, getCompositor()->getTextureId());
+
+  _correctionProgram->bind();
+  _correctionProgram->setUniformValue("frame", 0);
+  // gl_FragCoord is in device pixels.
+  _correctionProgram->setUniformValue("viewportSize", QSizeF(viewport()->size() * viewport()->devicePixelRatio()));
+  _correctionProgram->setUniformValue("blend",
+                                      _correction->getBlendLeft(), _correction->getBlendRight(),
+                                      _correction->getBlendTop(),  _correction->getBlendBottom());
+  _correctionProgram->setUniformValue("gamma", _correction->getBlendGamma());
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 0, vertices.constData());
+  glTexCoordPointer(2, GL_FLOAT, 0, texCoords.constData());
+  glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 2);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+
+  _correctionProgram->release();
+
+  glDisable(GL_TEXTURE_2D);
+
+  painter->endNativePainting();
+  painter->restore();
+}
+
+void OutputGLCanvas::_drawWarpGrid(QPainter* painter)
+{
+  painter->save();
+  painter->resetTransform();
+  painter->setPen(QPen(MM::CONTROL_COLOR, MM::SHAPE_STROKE_WIDTH));
+  painter->setBrush(Qt::NoBrush);
+
+  int nColumns = _correction->getWarpColumns();
+  int nRows    = _correction->getWarpRows();
+  for (int row=0; row<=nRows; row++)
+  {
+    for (int column=0; column<=nColumns; column++)
+    {
+      QPointF point = _fromNormalized(_correction->getWarpPoint(column, row));
+      if (column < nColumns)
+        painter->drawLine(point, _fromNormalized(_correction->getWarpPoint(column+1, row)));
+      if (row < nRows)
+        painter->drawLine(point, _fromNormalized(_correction->getWarpPoint(column, row+1)));
+
+      bool grabbed = (column == _grabbedWarpColumn && row == _grabbedWarpRow);
+      Util::drawControlsVertex(painter, point, grabbed, grabbed, false, MShape::DefaultMode);
+    }
+  }
+
+  painter->restore();
+}
+
 void OutputGLCanvas::setSceneRectToViewportGeometry()
 {
-  setSceneRect(viewport()->geometry());
+  if (_outputRegion.isNull())
+  {
+    resetTransform();
+    setSceneRect(viewport()->geometry());
+  }
+  else
+  {
+    // Stretch region over the whole viewport.
+    setSceneRect(_outputRegion);
+    setTransform(QTransform::fromScale(qreal(viewport()->width())  / _outputRegion.width(),
+                                       qreal(viewport()->height()) / _outputRegion.height()));
+  }
+}
+
+void OutputGLCanvas::setOutputRegion(const QRect& region)
+{
+  _outputRegion = region;
+  setSceneRectToViewportGeometry();
+  update();
 }
 
 void OutputGLCanvas::drawForeground(QPainter *painter , const QRectF &rect)
@@ -47,29 +243,16 @@ void OutputGLCanvas::drawForeground(QPainter *painter , const QRectF &rect)
   QSettings settings;
   bool controlOnMouseOver = settings.value("showControlOnMouseOver", MM::SHOW_OUTPUT_ON_MOUSE_HOVER).toBool();
 
-  if (_displayTestSignal)
+  if (_editingWarp)
   {
-    // Draw the preferred signal test card
-    int testCard = settings.value("signalTestCard", MM::DEFAULT_TEST_CARD).toInt();
-    glPushMatrix();
-    painter->translate(rect.x(), rect.y());
-    painter->setRenderHint(QPainter::Antialiasing);
-    painter->save();
-    switch (testCard) {
-    case MM::Classic:
-      _drawClassicTestSignal(painter);
-      break;
-    case MM::PAL:
-      _drawPALTestCard(painter);
-      break;
-    case MM::NTSC:
-      _drawNTSCTestCard(painter);
-      break;
-    default: // Do nothing;
-      break;
-    }
-    painter->restore();
-    glPopMatrix();
+    _drawWarpGrid(painter);
+  }
+  else if (_displayTestSignal)
+  {
+    // Draw the preferred signal test card (rasterized only when something changed).
+    _updateTestCard(settings.value("signalTestCard", MM::DEFAULT_TEST_CARD).toInt(),
+                    settings.value("showResolution", MM::SHOW_OUTPUT_RESOLUTION).toBool());
+    _drawTestCard(painter, sceneRect());
   }
   else if (!controlOnMouseOver || (MainWindow::window()->displayControls() && _windowIsHovered))
   {
@@ -110,21 +293,103 @@ void OutputGLCanvas::drawForeground(QPainter *painter , const QRectF &rect)
 
 }
 
+bool OutputGLCanvas::viewportEvent(QEvent *event)
+{
+  bool result = MapperGLCanvas::viewportEvent(event);
+
+  // Painting is over and buffers were swapped (auto buffer swap).
+  if (event->type() == QEvent::Paint)
+    emit framePresented();
+
+  return result;
+}
+
 void OutputGLCanvas::enterEvent(QEvent *event)
 {
   _windowIsHovered = true;
   QGraphicsView::enterEvent(event);
+
+  // Controls may appear on mouse over.
+  update();
 }
 
 void OutputGLCanvas::leaveEvent(QEvent *event)
 {
   _windowIsHovered = false;
   QGraphicsView::leaveEvent(event);
+
+  update();
 }
 
-void OutputGLCanvas::_drawClassicTestSignal(QPainter* painter)
+void OutputGLCanvas::_updateTestCard(int testCard, bool showResolution)
+{
+  QSize size = viewport()->size();
+  if (_testCardTexture &&
+      size == _testCardSize && testCard == _testCardType && showResolution == _testCardShowsResolution)
+    return;
+
+  _testCardSize = size;
+  _testCardType = testCard;
+  _testCardShowsResolution = showResolution;
+
+  // Rasterize card at output resolution.
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  image.fill(Qt::black);
+  {
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QRect geo(QPoint(0, 0), size);
+    switch (testCard) {
+    case MM::Classic:
+      _drawClassicTestSignal(&painter, geo);
+      break;
+    case MM::PAL:
+      _drawPALTestCard(&painter, geo);
+      break;
+    case MM::NTSC:
+      _drawNTSCTestCard(&painter, geo);
+      break;
+    default: // Do nothing;
+      break;
+    }
+  }
+
+  // Upload to texture.
+  QGLWidget* glWidget = static_cast<QGLWidget*>(viewport());
+  if (_testCardTexture)
+    glWidget->deleteTexture(_testCardTexture);
+  _testCardTexture = glWidget->bindTexture(image, GL_TEXTURE_2D, GL_RGBA,
+                                           QGLContext::InvertedYBindOption | QGLContext::LinearFilteringBindOption);
+}
+
+void OutputGLCanvas::_drawTestCard(QPainter* painter, const QRectF& target)
+{
+  painter->beginNativePainting();
+
+  glDisable(GL_BLEND);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, _testCardTexture);
+
+  glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+  // Texture is stored bottom-up.
+  glBegin(GL_QUADS);
+  {
+    glTexCoord2f(0, 1); glVertex2f(target.left(),  target.top());
+    glTexCoord2f(1, 1); glVertex2f(target.right(), target.top());
+    glTexCoord2f(1, 0); glVertex2f(target.right(), target.bottom());
+    glTexCoord2f(0, 0); glVertex2f(target.left(),  target.bottom());
+  }
+  glEnd();
+
+  glDisable(GL_TEXTURE_2D);
+
+  painter->endNativePainting();
+}
+
+void OutputGLCanvas::_drawClassicTestSignal(QPainter* painter, const QRect& geo)
 {
-  const QRect& geo = geometry();
   int width = geo.width();
   int height = geo.height();
   int rectSize = 10;
@@ -149,17 +414,16 @@ void OutputGLCanvas::_drawClassicTestSignal(QPainter* painter)
   }
 
   // Create responsive image
-  _classicTestCard = QImage(":/test-signal").scaled(height, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-  int imageX = (width - _classicTestCard.width()) / 2;
-  int imageY = (height - _classicTestCard.height()) / 2;
+  QImage classicTestCard = QImage(":/test-signal").scaled(height, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+  int imageX = (width - classicTestCard.width()) / 2;
+  int imageY = (height - classicTestCard.height()) / 2;
 
   // Draw the image.
-  painter->drawImage(imageX, imageY, _classicTestCard);
+  painter->drawImage(imageX, imageY, classicTestCard);
 }
 
-void OutputGLCanvas::_drawPALTestCard(QPainter* painter)
+void OutputGLCanvas::_drawPALTestCard(QPainter* painter, const QRect& geo)
 {
-  const QRect& geo = geometry();
   int width = geo.width();
   int height = geo.height();
   int rectSize = 85;
@@ -192,31 +456,30 @@ void OutputGLCanvas::_drawPALTestCard(QPainter* painter)
   }
 
   // Create responsive image
-  _palTestCard = QImage(":/pal-test-card").scaled(height - (rectSize * 2), height - (rectSize * 2),
-                                           Qt::KeepAspectRatio, Qt::SmoothTransformation);
+  QImage palTestCard = QImage(":/pal-test-card").scaled(height - (rectSize * 2), height - (rectSize * 2),
+                                                 Qt::KeepAspectRatio, Qt::SmoothTransformation);
   // Draw image
-  int imageX = (width - _palTestCard.width()) / 2;
-  int imageY = (height - _palTestCard.height()) / 2;
-  int imageHeight = _palTestCard.height();
-  painter->drawImage(imageX, imageY, _palTestCard);
+  int imageX = (width - palTestCard.width()) / 2;
+  int imageY = (height - palTestCard.height()) / 2;
+  int imageHeight = palTestCard.height();
+  painter->drawImage(imageX, imageY, palTestCard);
 
   // Draw text for screen resolution
   int fontSize = imageHeight / 18;
   QRect textRect((width / 2) - (fontSize * 3), imageY + (imageHeight / 19), fontSize * 6, fontSize);
-  _drawResolutionText(painter, textRect, fontSize);
+  _drawResolutionText(painter, textRect, fontSize, geo.size());
 }
 
-void OutputGLCanvas::_drawNTSCTestCard(QPainter* painter)
+void OutputGLCanvas::_drawNTSCTestCard(QPainter* painter, const QRect& geo)
 {
-  const QRect& geo = geometry();
   int width = geo.width();
   int height = geo.height();
 
   // Create image
-  _ntscTestCard = QImage(":/ntsc-test-card").scaled(width, height);
+  QImage ntscTestCard = QImage(":/ntsc-test-card").scaled(width, height);
 
   // Draw backgroung image
-  painter->drawImage(geo.x(), geo.y(), _ntscTestCard);
+  painter->drawImage(geo.x(), geo.y(), ntscTestCard);
   // Draw logo
   QImage mapmapLogo = QImage(":/mapmap-logo-with-border").scaled(width, height / 15, Qt::KeepAspectRatio, Qt::SmoothTransformation);
   painter->drawImage((width - mapmapLogo.width()) / 2, height / 4, mapmapLogo);
@@ -225,10 +488,10 @@ void OutputGLCanvas::_drawNTSCTestCard(QPainter* painter)
   // Draw text for screen resolution
   int fontSize = height / 21;
   QRect textRect((width / 2) - (fontSize * 3), height / 3, fontSize * 6, fontSize);
-  _drawResolutionText(painter, textRect, fontSize);
+  _drawResolutionText(painter, textRect, fontSize, geo.size());
 }
 
-void OutputGLCanvas::_drawResolutionText(QPainter *painter, const QRect &rect, int fontSize)
+void OutputGLCanvas::_drawResolutionText(QPainter *painter, const QRect &rect, int fontSize, const QSize& resolution)
 {
   QSettings settings;
 
@@ -241,8 +504,8 @@ void OutputGLCanvas::_drawResolutionText(QPainter *painter, const QRect &rect, i
     painter->setFont(font);
     painter->setPen(Qt::white);
     painter->drawText(rect, Qt::AlignCenter,
-                      QString::number(geometry().width()) +
-                      " x " + QString::number(geometry().height()));
+                      QString::number(resolution.width()) +
+                      " x " + QString::number(resolution.height()));
   }
 }
 
@@ -251,13 +514,80 @@ void OutputGLCanvas::resizeGL(int width, int height)
   setSceneRectToViewportGeometry();
 }
 
+void OutputGLCanvas::resizeEvent(QResizeEvent *event)
+{
+  MapperGLCanvas::resizeEvent(event);
+  setSceneRectToViewportGeometry();
+}
+
 void OutputGLCanvas::wheelEvent(QWheelEvent *event)
 {
   event->ignore();
 }
 
+void OutputGLCanvas::mousePressEvent(QMouseEvent *event)
+{
+  if (_editingWarp)
+  {
+    // Grab closest warp point.
+    qreal closestDistance = MM::VERTEX_SELECT_RADIUS;
+    _grabbedWarpColumn = _grabbedWarpRow = -1;
+    for (int row=0; row<=_correction->getWarpRows(); row++)
+    {
+      for (int column=0; column<=_correction->getWarpColumns(); column++)
+      {
+        QPointF diff = _fromNormalized(_correction->getWarpPoint(column, row)) - event->pos();
+        qreal distance = sqrt(QPointF::dotProduct(diff, diff));
+        if (distance <= closestDistance)
+        {
+          closestDistance = distance;
+          _grabbedWarpColumn = column;
+          _grabbedWarpRow = row;
+          _grabbedWarpStartPoint = _correction->getWarpPoint(column, row);
+        }
+      }
+    }
+    update();
+  }
+  else
+    MapperGLCanvas::mousePressEvent(event);
+}
+
+void OutputGLCanvas::mouseReleaseEvent(QMouseEvent *event)
+{
+  if (_editingWarp)
+  {
+    // Close the drag so that the next one is undone separately.
+    if (_grabbedWarpColumn >= 0 &&
+        _correction->getWarpPoint(_grabbedWarpColumn, _grabbedWarpRow) != _grabbedWarpStartPoint)
+      MainWindow::window()->getUndoStack()->push(
+            new MoveWarpPointCommand(_correction, TransformShapeCommand::RELEASE,
+                                     _grabbedWarpColumn, _grabbedWarpRow,
+                                     _correction->getWarpPoint(_grabbedWarpColumn, _grabbedWarpRow)));
+    _grabbedWarpColumn = _grabbedWarpRow = -1;
+    update();
+  }
+  else
+    MapperGLCanvas::mouseReleaseEvent(event);
+}
+
 void OutputGLCanvas::mouseMoveEvent(QMouseEvent *event)
 {
+  if (_editingWarp)
+  {
+    // Drag grabbed warp point.
+    if (_grabbedWarpColumn >= 0)
+    {
+      MainWindow::window()->getUndoStack()->push(
+            new MoveWarpPointCommand(_correction, TransformShapeCommand::FREE,
+                                     _grabbedWarpColumn, _grabbedWarpRow,
+                                     QPointF(qreal(event->pos().x()) / viewport()->width(),
+                                             qreal(event->pos().y()) / viewport()->height())));
+      update();
+    }
+    return;
+  }
+
   // Click-and-drag translate view.
   if (event->buttons() & Qt::MiddleButton)
   {
@@ -267,6 +597,10 @@ void OutputGLCanvas::mouseMoveEvent(QMouseEvent *event)
   {
     MapperGLCanvas::mouseMoveEvent(event);
   }
+
+  // Crosshair follows mouse.
+  if (_displayCrosshair)
+    update();
 }
 
 }
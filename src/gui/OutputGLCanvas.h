@@ -22,7 +22,10 @@
 #ifndef OUTPUTGLCANVAS_H_
 #define OUTPUTGLCANVAS_H_
 
+#include <QGLShaderProgram>
+
 #include "MapperGLCanvas.h"
+#include "OutputCorrection.h"
 
 namespace mmp {
 
@@ -32,14 +35,32 @@ class OutputGLCanvas: public MapperGLCanvas
 
 public:
   OutputGLCanvas(MainWindow* mainWindow, QWidget* parent = 0, const QGLWidget* shareWidget = 0, QGraphicsScene* scene = 0);
-  virtual ~OutputGLCanvas() {}
+  virtual ~OutputGLCanvas();
 
-  // Adjust viewable scene to correspond to absolute coordinates.
+  // Adjust viewable scene to correspond to absolute coordinates (or to output region if set).
   void setSceneRectToViewportGeometry();
 
+  /// Sets the region of the composition displayed by this canvas (null rectangle for whole viewport).
+  void setOutputRegion(const QRect& region);
+
+  /// Returns the region of the composition displayed by this canvas (null if none).
+  const QRect& getOutputRegion() const { return _outputRegion; }
+
   // Draws foreground (displays crosshair if needed).
   void drawForeground(QPainter *painter , const QRectF &rect);
 
+  // Draws the composition, corrected if needed.
+  void drawBackground(QPainter *painter, const QRectF &rect);
+
+  /// Sets the warp and edge blend applied to this output.
+  void setCorrection(OutputCorrection::ptr correction);
+
+  /// Returns the warp and edge blend applied to this output.
+  OutputCorrection::ptr getCorrection() const { return _correction; }
+
+  /// Sets whether warp points can be dragged with the mouse (the warp grid is then displayed).
+  void setEditingWarp(bool editing);
+
 public:
   void setDisplayCrosshair(bool displayCrosshair) {
     _displayCrosshair = displayCrosshair;
@@ -50,25 +71,65 @@ public:
   }
 
 private:
-  void _drawClassicTestSignal(QPainter* painter);
-  void _drawPALTestCard(QPainter *painter);
-  void _drawNTSCTestCard(QPainter *painter);
+  // Rasterizes the test card into a texture iff output size or card settings changed.
+  void _updateTestCard(int testCard, bool showResolution);
+
+  // Draws the cached test card texture over target (in painter coordinates).
+  void _drawTestCard(QPainter* painter, const QRectF& target);
+
+  void _drawClassicTestSignal(QPainter* painter, const QRect& geo);
+  void _drawPALTestCard(QPainter *painter, const QRect& geo);
+  void _drawNTSCTestCard(QPainter *painter, const QRect& geo);
 
-  void _drawResolutionText(QPainter *painter, const QRect &rect, int fontSize);
+  void _drawResolutionText(QPainter *painter, const QRect &rect, int fontSize, const QSize& resolution);
+
+  // Draws the composition through the warp grid and blend masks (single shader pass).
+  void _drawCorrectedComposition(QPainter* painter);
+
+  // Draws the warp grid and its points.
+  void _drawWarpGrid(QPainter* painter);
+
+  // Returns the viewport position of a normalized output position.
+  QPointF _fromNormalized(const QPointF& point) const;
 
   bool _displayCrosshair;
   bool _displayTestSignal;
-  QImage _classicTestCard;
   QBrush _brush_test_signal;
-  QImage _palTestCard;
-  QImage _ntscTestCard;
+
+  // Test card cache (texture and the settings it was rendered with).
+  GLuint _testCardTexture;
+  QSize _testCardSize;
+  int _testCardType;
+  bool _testCardShowsResolution;
+
   bool _windowIsHovered;
+  QRect _outputRegion;
+
+  // Output correction.
+  OutputCorrection::ptr _correction;
+  QGLShaderProgram* _correctionProgram;
+  bool _editingWarp;
+  int _grabbedWarpColumn;
+  int _grabbedWarpRow;
+  QPointF _grabbedWarpStartPoint;
+
+signals:
+  /// Emitted after each repaint, once buffers have been swapped.
+  void framePresented();
 
 protected:
   // overriden from QGlWidget:
   virtual void resizeGL(int width, int height);
 
+  // Overriden to emit framePresented() after painting.
+  virtual bool viewportEvent(QEvent *event);
+
+  // Keeps scene rect in sync with viewport size.
+  virtual void resizeEvent(QResizeEvent *event);
+
   void wheelEvent(QWheelEvent *event);
+  void mousePressEvent(QMouseEvent *event);
+  void mouseReleaseEvent(QMouseEvent *event);
   void mouseMoveEvent(QMouseEvent *event);
   void enterEvent(QEvent * event);
   void leaveEvent(QEvent *event);
@@ -59,6 +59,16 @@ public:
   int getPreferredScreen() const { return _preferredScreen; }
   void setPreferredScreen(int screen);
 
+  /// Sets the region of the composition displayed in this window (null rectangle for default).
+  void setOutputRegion(const QRect& region) { canvas->setOutputRegion(region); }
+  const QRect& getOutputRegion() const { return canvas->getOutputRegion(); }
+
+  /// Sets the warp and edge blend applied to this window.
+  void setCorrection(OutputCorrection::ptr correction) { canvas->setCorrection(correction); }
+
+  /// Sets whether warp points of this window can be dragged with the mouse.
+  void setEditingWarp(bool editing) { canvas->setEditingWarp(editing); }
+
 private:
   OutputGLCanvas* canvas;
 
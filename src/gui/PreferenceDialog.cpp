@@ -112,6 +112,14 @@ bool PreferenceDialog::loadSettings()
   _showResolutionBox->setChecked(settings.value("showResolution", MM::SHOW_OUTPUT_RESOLUTION).toBool());
   // Show control on mouse hover
   _showControlOnOverBox->setChecked(settings.value("showControlOnMouseOver", MM::SHOW_OUTPUT_ON_MOUSE_HOVER).toBool());
+  // Native output rendering
+  _nativeRenderingBox->setChecked(settings.value("nativeOutputRendering", MM::NATIVE_OUTPUT_RENDERING).toBool());
+  // Render resolution
+  int renderScaleIndex = _renderScaleBox->findData(settings.value("renderScale", MM::DEFAULT_RENDER_SCALE).toReal());
+  _renderScaleBox->setCurrentIndex(renderScaleIndex >= 0 ? renderScaleIndex : 1);
+  // Shared memory output
+  _sharedMemoryOutputBox->setChecked(settings.value("sharedMemoryOutput", MM::SHARED_MEMORY_OUTPUT).toBool());
+  _sharedMemoryPathEdit->setText(settings.value("sharedMemoryOutputPath", MM::DEFAULT_SHARED_MEMORY_OUTPUT_PATH).toString());
   // Set preferred test signal pattern
   _radioGroup.at(settings.value("signalTestCard", MM::DEFAULT_TEST_CARD).toInt())->setChecked(true);
   // Set toolbar icon size
@@ -143,6 +151,20 @@ void PreferenceDialog::applySettings()
   settings.setValue("showResolution", _showResolutionBox->isChecked());
   // Show control on mouse hover
   settings.setValue("showControlOnMouseOver", _showControlOnOverBox->isChecked());
+  // Native output rendering
+  settings.setValue("nativeOutputRendering", _nativeRenderingBox->isChecked());
+  mainWindow->setNativeOutputRendering(_nativeRenderingBox->isChecked());
+  // Render resolution
+  settings.setValue("renderScale", _renderScaleBox->currentData());
+  mainWindow->setRenderScale(_renderScaleBox->currentData().toReal());
+  // Shared memory output (only restarted if changed)
+  if (settings.value("sharedMemoryOutput", MM::SHARED_MEMORY_OUTPUT).toBool() != _sharedMemoryOutputBox->isChecked() ||
+      settings.value("sharedMemoryOutputPath", MM::DEFAULT_SHARED_MEMORY_OUTPUT_PATH).toString() != _sharedMemoryPathEdit->text())
+  {
+    settings.setValue("sharedMemoryOutput", _sharedMemoryOutputBox->isChecked());
+    settings.setValue("sharedMemoryOutputPath", _sharedMemoryPathEdit->text());
+    mainWindow->setSharedMemoryOutput(_sharedMemoryOutputBox->isChecked(), _sharedMemoryPathEdit->text());
+  }
   // Set preferred test signal pattern
   for (QRadioButton *radio: _radioGroup) {
     if (radio->isChecked()) {
@@ -247,8 +269,26 @@ void PreferenceDialog::createOutputPage()
 
   _showControlOnOverBox = new QCheckBox(tr("Only show output controls on mouse over"));
 
+  _nativeRenderingBox = new QCheckBox(tr("Render output natively (faster, bypasses the scene graph)"));
+
+  _renderScaleBox = new QComboBox;
+  _renderScaleBox->addItem(tr("Half (faster)"), 0.5);
+  _renderScaleBox->addItem(tr("Native"), 1.0);
+  _renderScaleBox->addItem(tr("Double (supersampled)"), 2.0);
+
+  QFormLayout *renderScaleForm = new QFormLayout;
+  renderScaleForm->setFieldGrowthPolicy(QFormLayout::FieldsStayAtSizeHint);
+  renderScaleForm->addRow(tr("Render resolution"), _renderScaleBox);
+
+  _sharedMemoryOutputBox = new QCheckBox(tr("Publish output to shared memory (shmsink)"));
+  _sharedMemoryPathEdit = new QLineEdit;
+  renderScaleForm->addRow(_sharedMemoryOutputBox);
+  renderScaleForm->addRow(tr("Socket path"), _sharedMemoryPathEdit);
+
   QVBoxLayout *outputLayout = new QVBoxLayout;
   outputLayout->addWidget(_showControlOnOverBox);
+  outputLayout->addWidget(_nativeRenderingBox);
+  outputLayout->addLayout(renderScaleForm);
 
   QGroupBox *outputGroupBox = new QGroupBox(tr("Output Layers"));
   outputGroupBox->setLayout(outputLayout);
@@ -97,6 +97,10 @@ private:
   QLabel *_palTestImg;
   QLabel *_ntscTestImg;
   QCheckBox *_showControlOnOverBox;
+  QCheckBox *_nativeRenderingBox;
+  QComboBox *_renderScaleBox;
+  QCheckBox *_sharedMemoryOutputBox;
+  QLineEdit *_sharedMemoryPathEdit;
 
   // Controls widgets
   // OSC
@@ -97,10 +97,10 @@ void MeshControlPainter::paintShape(QPainter *painter, MapperGLCanvas* canvas, b
   painter->setBrush(Qt::NoBrush);
 
   // Draw inner quads.
-  QVector<Quad::ptr> quads = mesh->getQuads();
-  for (QVector<Quad::ptr>::const_iterator it = quads.begin(); it != quads.end(); ++it)
+  for (int x = 0; x < mesh->nHorizontalQuads(); x++)
   {
-    painter->drawPolygon((*it)->toPolygon());
+    for (int y = 0; y < mesh->nVerticalQuads(); y++)
+      painter->drawPolygon(mesh->getCell(x, y).toPolygon());
   }
 
   // Draw outer quad.
@@ -50,12 +50,8 @@ void ShapeGraphicsItem::paint(QPainter *painter,
 {
   Q_UNUSED(widget);
 
-  // Sync depth of figure with that of mapping (for layered output).
-  if (isOutput())
-    setZValue(getMapping()->getDepth());
-
   // Paint if visible.
-  if (isMappingVisible())
+  if (prepareToPaint())
   {
     // Paint whatever needs to be painted.
     _prePaint(painter, option);
@@ -64,6 +60,15 @@ void ShapeGraphicsItem::paint(QPainter *painter,
   }
 }
 
+bool ShapeGraphicsItem::prepareToPaint()
+{
+  // Sync depth of figure with that of mapping (for layered output).
+  if (isOutput())
+    setZValue(getMapping()->getDepth());
+
+  return isMappingVisible();
+}
+
 //void VertexGraphicsItem::mousePressEvent(QGraphicsSceneMouseEvent * event)
 //{
 //  ShapeGraphicsItem* shapeParent = static_cast<ShapeGraphicsItem*>(parentItem());
@@ -127,6 +132,92 @@ void ColorGraphicsItem::_prePaint(QPainter *painter,
   painter->setBrush(col);
 }
 
+void ColorGraphicsItem::appendGeometry(ColorBatch& batch)
+{
+  Color* color = static_cast<Color*>(getMapping()->getPaint().data());
+  Q_ASSERT(color);
+
+  QColor col = color->getColor();
+  col.setAlphaF(getMapping()->getComputedOpacity());
+  batch.setColor(col);
+
+  _updateTessellation();
+  for (int i=0; i<_triangles.size(); i++)
+    batch.addVertex(_triangles[i]);
+  for (int i=0; i<_fringe.size(); i++)
+    batch.addVertex(_fringe[i], _fringeCoverage[i]);
+}
+
+void ColorGraphicsItem::_updateTessellation()
+{
+  // Only tessellate again if the shape changed.
+  quint64 version = getShape()->getVersion();
+  if (version == _tessellatedVersion)
+    return;
+  _tessellatedVersion = version;
+
+  QPolygonF outline;
+  _triangles.resize(0);
+  _tessellate(_triangles, outline);
+  _buildFringe(outline);
+}
+
+void ColorGraphicsItem::_buildFringe(const QPolygonF& outline)
+{
+  _fringe.resize(0);
+  _fringeCoverage.resize(0);
+
+  QPolygonF contour = outline;
+  if (contour.size() > 1 && contour.isClosed())
+    contour.removeLast();
+
+  int n = contour.size();
+  if (n < 3)
+    return;
+
+  // Orientation of the contour tells on which side of the edges the outside is.
+  qreal area = 0;
+  for (int i=0, j=n-1; i<n; j=i++)
+    area += contour[j].x()*contour[i].y() - contour[i].x()*contour[j].y();
+  qreal side = (area > 0 ? 1 : -1);
+
+  // Outward offset of each edge.
+  QVector<QPointF> offsets(n);
+  for (int i=0; i<n; i++)
+  {
+    QPointF edge = contour[(i+1) % n] - contour[i];
+    qreal length = sqrt(QPointF::dotProduct(edge, edge));
+    offsets[i] = (length > 0 ?
+                  QPointF(edge.y(), -edge.x()) * (side * MM::COLOR_ANTIALIASING_WIDTH / length) :
+                  QPointF());
+  }
+
+  // Each edge is extruded into a quad fading to transparent, with a wedge filling
+  // the gap at the next corner if it is convex (at concave corners, the quads of
+  // both edges already overlap).
+  for (int i=0; i<n; i++)
+  {
+    const QPointF& a = contour[i];
+    const QPointF& b = contour[(i+1) % n];
+    const QPointF& c = contour[(i+2) % n];
+    const QPointF& offset = offsets[i];
+    const QPointF& nextOffset = offsets[(i+1) % n];
+
+    _fringe << a << b << b + offset
+            << a << b + offset << a + offset;
+    _fringeCoverage << 1 << 1 << 0
+                    << 1 << 0 << 0;
+
+    // Corner turns the same way as the contour: convex.
+    qreal turn = (b.x() - a.x())*(c.y() - b.y()) - (b.y() - a.y())*(c.x() - b.x());
+    if (turn * side > 0)
+    {
+      _fringe << b << b + offset << b + nextOffset;
+      _fringeCoverage << 1 << 0 << 0;
+    }
+  }
+}
+
 PolygonColorGraphicsItem::PolygonColorGraphicsItem(Mapping::ptr mapping, bool output)
   : ColorGraphicsItem(mapping, output) {
   _controlPainter.reset(new PolygonControlPainter(this));
@@ -150,6 +241,16 @@ void PolygonColorGraphicsItem::_doPaint(QPainter *painter,
   painter->drawPolygon(mapFromScene(poly->toPolygon()));
 }
 
+void PolygonColorGraphicsItem::_tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const
+{
+  Polygon* poly = static_cast<Polygon*>(_shape.data());
+  Q_ASSERT(poly);
+
+  // Polygon might be concave.
+  outline = mapFromScene(poly->toPolygon());
+  Util::triangulate(outline, triangles);
+}
+
 MeshColorGraphicsItem::MeshColorGraphicsItem(Mapping::ptr mapping, bool output)
 : PolygonColorGraphicsItem(mapping, output)
 {
@@ -162,16 +263,37 @@ void MeshColorGraphicsItem::_doPaint(QPainter *painter,
   Q_UNUSED(option);
 
   Mesh* mesh = static_cast<Mesh*>(_shape.data());
-  QVector<QVector<Quad::ptr> > quads = mesh->getQuads2d();
 
   // Go through the mesh quad by quad.
   for (int x = 0; x < mesh->nHorizontalQuads(); x++)
   {
     for (int y = 0; y < mesh->nVerticalQuads(); y++)
     {
-      Quad::ptr quad = quads[x][y];
+      painter->drawPolygon(mapFromScene(mesh->getCell(x, y).toPolygon()));
+    }
+  }
+}
+
+void MeshColorGraphicsItem::_tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const
+{
+  Mesh* mesh = static_cast<Mesh*>(_shape.data());
 
-      painter->drawPolygon(mapFromScene(quad->toPolygon()));
+  outline = mapFromScene(mesh->toPolygon());
+  triangles.reserve(mesh->nHorizontalQuads() * mesh->nVerticalQuads() * 6);
+  for (int x = 0; x < mesh->nHorizontalQuads(); x++)
+  {
+    for (int y = 0; y < mesh->nVerticalQuads(); y++)
+    {
+      QuadF quad = mesh->getCell(x, y);
+      for (int i = 0; i < 4; i++)
+        quad[i] = mapFromScene(quad[i]);
+      // Cells may be concave.
+      if (Util::quadSplitsAlongAC(quad[0], quad[1], quad[2], quad[3]))
+        triangles << quad[0] << quad[1] << quad[2]
+                  << quad[0] << quad[2] << quad[3];
+      else
+        triangles << quad[0] << quad[1] << quad[3]
+                  << quad[1] << quad[2] << quad[3];
     }
   }
 }
@@ -202,8 +324,23 @@ void EllipseColorGraphicsItem::_doPaint(QPainter* painter,
   painter->drawPath(shape());
 }
 
+void EllipseColorGraphicsItem::_tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const
+{
+  Ellipse* ellipse = static_cast<Ellipse*>(_shape.data());
+  Q_ASSERT(ellipse);
+
+  // Triangle fan around the center (the ellipse is convex).
+  QPointF center = mapFromScene(ellipse->getCenter());
+  outline = shape().toFillPolygon();
+  for (int i=1; i<outline.size(); i++)
+    triangles << center << outline[i-1] << outline[i];
+}
+
 TextureGraphicsItem::TextureGraphicsItem(Mapping::ptr mapping, bool output)
-  : ShapeGraphicsItem(mapping, output)
+  : ShapeGraphicsItem(mapping, output),
+    _hasCachedGeometry(false),
+    _cachedInputVersion(0), _cachedOutputVersion(0), _cachedTextureVersion(0),
+    _cachedTexture(0)
 {
   _textureMapping = qSharedPointerCast<TextureMapping>(mapping);
   Q_CHECK_PTR(_textureMapping);
@@ -231,7 +368,7 @@ void TextureGraphicsItem::_doDrawInput(QPainter* painter)
     // FIXME: Does this draw the quad counterclockwise?
     glBegin (GL_QUADS);
     {
-      QRectF rect = mapFromScene(_getTexture()->getRect()).boundingRect();
+      QRectF rect = mapFromScene(getTexture()->getRect()).boundingRect();
 
       Util::correctGlTexCoord(0, 0);
       glVertex3f (rect.x(), rect.y(), 0);
@@ -249,14 +386,48 @@ void TextureGraphicsItem::_doDrawInput(QPainter* painter)
   }
 }
 
-void TextureGraphicsItem::_prePaint(QPainter* painter,
-                                    const QStyleOptionGraphicsItem *option)
+void TextureGraphicsItem::_doDrawOutput(QPainter* painter)
 {
-	QSharedPointer<Texture> texture = _getTexture();
-	Q_CHECK_PTR(texture);
+  Q_UNUSED(painter);
 
-  Q_UNUSED(option);
-  painter->beginNativePainting();
+  // Draw this item as a batch of its own.
+  TextureBatch batch;
+  appendGeometry(batch);
+  batch.draw();
+}
+
+void TextureGraphicsItem::appendGeometry(TextureBatch& batch)
+{
+  // Rebuild geometry only when something it depends on changed.
+  if (!_hasCachedGeometry || _outputGeometryChanged())
+  {
+    _cachedGeometry.clear();
+    _appendOutputGeometry(_cachedGeometry);
+
+    QSharedPointer<Texture> texture = getTexture();
+    _cachedInputVersion   = _inputShape.toStrongRef()->getVersion();
+    _cachedOutputVersion  = getShape()->getVersion();
+    _cachedTexture        = texture.data();
+    _cachedTextureVersion = texture->getGeometryVersion();
+    _hasCachedGeometry = true;
+  }
+
+  batch.setColor(1.0f, 1.0f, 1.0f, getMapping()->getComputedOpacity());
+  batch.append(_cachedGeometry);
+}
+
+bool TextureGraphicsItem::_outputGeometryChanged()
+{
+  QSharedPointer<Texture> texture = getTexture();
+  return (_cachedInputVersion   != _inputShape.toStrongRef()->getVersion() ||
+          _cachedOutputVersion  != getShape()->getVersion() ||
+          _cachedTexture        != texture.data() ||
+          _cachedTextureVersion != texture->getGeometryVersion());
+}
+
+void TextureGraphicsItem::bindTexture(const QSharedPointer<Texture>& texture)
+{
+  Q_CHECK_PTR(texture);
 
   // Project source texture and sent it to destination.
   texture->update();
@@ -273,6 +444,11 @@ void TextureGraphicsItem::_prePaint(QPainter* painter,
   glEnable (GL_TEXTURE_2D);
   glBindTexture(GL_TEXTURE_2D, texture->getTextureId());
 
+  uploadTexture(texture);
+}
+
+void TextureGraphicsItem::uploadTexture(const QSharedPointer<Texture>& texture)
+{
   // Copy bits to texture iff necessary.
   texture->lockMutex();
   if (texture->bitsHaveChanged())
@@ -293,6 +469,15 @@ void TextureGraphicsItem::_prePaint(QPainter* painter,
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void TextureGraphicsItem::_prePaint(QPainter* painter,
+                                    const QStyleOptionGraphicsItem *option)
+{
+  Q_UNUSED(option);
+  painter->beginNativePainting();
+
+  bindTexture(getTexture());
 
   // Set texture color (apply opacity).
   glColor4f(1.0f, 1.0f, 1.0f,
@@ -310,7 +495,7 @@ void TextureGraphicsItem::_postPaint(QPainter* painter,
   painter->endNativePainting();
 }
 
-QSharedPointer<Texture> TextureGraphicsItem::_getTexture()
+QSharedPointer<Texture> TextureGraphicsItem::getTexture() const
 {
   return qSharedPointerCast<Texture>(_textureMapping.toStrongRef()->getPaint());
 }
@@ -328,20 +513,16 @@ QRectF PolygonTextureGraphicsItem::boundingRect() const {
   return shape().boundingRect();
 }
 
-void TriangleTextureGraphicsItem::_doDrawOutput(QPainter* painter)
+void TriangleTextureGraphicsItem::_appendOutputGeometry(TextureBatch& batch)
 {
-  Q_UNUSED(painter);
   if (isOutput())
   {
     MShape::ptr inputShape = _inputShape.toStrongRef();
-    glBegin(GL_TRIANGLES);
+    QSharedPointer<Texture> texture = getTexture();
+    for (int i=0; i<inputShape->nVertices(); i++)
     {
-      for (int i=0; i<inputShape->nVertices(); i++)
-      {
-        Util::setGlTexPoint(*_getTexture(), inputShape->getVertex(i), mapFromScene(getShape()->getVertex(i)));
-      }
+      batch.addVertex(*texture, inputShape->getVertex(i), mapFromScene(getShape()->getVertex(i)));
     }
-    glEnd();
   }
 }
 
@@ -355,31 +536,30 @@ MeshTextureGraphicsItem::MeshTextureGraphicsItem(Mapping::ptr mapping, bool outp
   _wasGrabbing = false;
 }
 
-void MeshTextureGraphicsItem::_doDrawOutput(QPainter* painter)
+void MeshTextureGraphicsItem::_appendOutputGeometry(TextureBatch& batch)
 {
-  Q_UNUSED(painter);
   if (isOutput())
   {
+    QSharedPointer<Texture> texture = getTexture();
     QSharedPointer<Mesh> outputMesh = qSharedPointerCast<Mesh>(_shape);
     QSharedPointer<Mesh> inputMesh  = qSharedPointerCast<Mesh>(_inputShape);
-    QVector<QVector<Quad::ptr> > outputQuads = outputMesh->getQuads2d();
-    QVector<QVector<Quad::ptr> > inputQuads  = inputMesh->getQuads2d();
 
-    // Check if we increased or decreased number of columns/rows in mesh.
+    // Check if we increased or decreased number of columns/rows in mesh. Cells keep their
+    // cached sub-quads: they are only rebuilt below if their own quads changed.
     bool forceRebuild = false;
     if (_nHorizontalQuads != outputMesh->nHorizontalQuads() ||
         _nVerticalQuads != outputMesh->nVerticalQuads())
     {
-      forceRebuild = true;
-      _cachedQuadItems.resize(_nHorizontalQuads = outputMesh->nHorizontalQuads());
+      _nHorizontalQuads = outputMesh->nHorizontalQuads();
+      _nVerticalQuads   = outputMesh->nVerticalQuads();
+      _cachedQuadItems.resize(_nHorizontalQuads);
       for (int i=0; i<_nHorizontalQuads; i++)
-        _cachedQuadItems[i].resize(_nVerticalQuads = outputMesh->nVerticalQuads());
+        _cachedQuadItems[i].resize(_nVerticalQuads);
     }
 
     // Keep track of whether we are currently grabbing the shape or a vertex so as to
     // reduce resolution when editing (to prevent lags).
-    bool grabbing = (isMappingCurrent() &&
-                     (getCanvas()->shapeGrabbed() || getCanvas()->vertexGrabbed()));
+    bool grabbing = _isGrabbing();
 
     // Max depth is adjusted to draw less quads during click & drag.
     int maxDepth = (grabbing ? MM::MESH_SUBDIVISION_MAX_DEPTH_EDITING : MM::MESH_SUBDIVISION_MAX_DEPTH);
@@ -395,14 +575,14 @@ void MeshTextureGraphicsItem::_doDrawOutput(QPainter* painter)
     {
       for (int y = 0; y < outputMesh->nVerticalQuads(); y++)
       {
-        Quad::ptr inputQuad  = inputQuads[x][y];
-        Quad::ptr outputQuad = outputQuads[x][y];
+        QuadF inputQuad  = inputMesh->getCell(x, y);
+        QuadF outputQuad = outputMesh->getCell(x, y);
 
         // Verify if item needs recomputing.
         CacheQuadItem& item = _cachedQuadItems[x][y];
         if (forceRebuild ||
-            item.parent.input->toPolygon()  != inputQuad->toPolygon() ||
-            item.parent.output->toPolygon() != outputQuad->toPolygon()) {
+            item.parent.input  != inputQuad ||
+            item.parent.output != outputQuad) {
 
           // Copy input and output quads for verification purposes.
           item.parent.input  = inputQuad;
@@ -411,43 +591,53 @@ void MeshTextureGraphicsItem::_doDrawOutput(QPainter* painter)
           // Recompute sub quads.
           item.subQuads.clear();
 
-          QSizeF size = mapFromScene(outputQuad->toPolygon()).boundingRect().size();
+          QSizeF size = mapFromScene(outputQuad.toPolygon()).boundingRect().size();
           float area = size.width() * size.height();
 
           // Rebuild cache quad item.
           _buildCacheQuadItem(item, inputQuad, outputQuad, area, 0.0001f, 0.001f, MM::MESH_SUBDIVISION_MIN_AREA, maxDepth);
         }
 
-        // Draw all the cached items.
-        for (CacheQuadMapping m: item.subQuads)
+        // Add all the cached items.
+        for (const CacheQuadMapping& m: item.subQuads)
         {
-          glBegin(GL_QUADS);
-          for (int i = 0; i < outputQuad->nVertices(); i++)
-          {
-            Util::setGlTexPoint(*_getTexture(), m.input->getVertex(i), mapFromScene(m.output->getVertex(i)));
-          }
-          glEnd();
+          QPointF output[4];
+          for (int i = 0; i < 4; i++)
+            output[i] = mapFromScene(m.output[i]);
+          batch.addQuad(*texture, m.input.p, output);
         }
       }
     }
   }
 }
 
-void MeshTextureGraphicsItem::_buildCacheQuadItem(CacheQuadItem& item, const Quad::ptr& inputQuad, const Quad::ptr& outputQuad, float outputArea, float inputThreshod, float outputThreshold, int minArea, int maxDepth)
+bool MeshTextureGraphicsItem::_outputGeometryChanged()
+{
+  // Resolution changes when grabbing starts or stops.
+  return (TextureGraphicsItem::_outputGeometryChanged() || _isGrabbing() != _wasGrabbing);
+}
+
+bool MeshTextureGraphicsItem::_isGrabbing() const
+{
+  return (isMappingCurrent() &&
+          (getCanvas()->shapeGrabbed() || getCanvas()->vertexGrabbed()));
+}
+
+void MeshTextureGraphicsItem::_buildCacheQuadItem(CacheQuadItem& item, const QuadF& inputQuad, const QuadF& outputQuad, float outputArea, float inputThreshod, float outputThreshold, int minArea, int maxDepth)
 {
   bool stop = false;
   if (maxDepth == 0 || outputArea < minArea)
     stop = true;
   else {
-    QPointF oa = mapFromScene(outputQuad->getVertex(0));
-    QPointF ob = mapFromScene(outputQuad->getVertex(1));
-    QPointF oc = mapFromScene(outputQuad->getVertex(2));
-    QPointF od = mapFromScene(outputQuad->getVertex(3));
+    QPointF oa = mapFromScene(outputQuad[0]);
+    QPointF ob = mapFromScene(outputQuad[1]);
+    QPointF oc = mapFromScene(outputQuad[2]);
+    QPointF od = mapFromScene(outputQuad[3]);
 
-    QPointF ia = inputQuad->getVertex(0);
-    QPointF ib = inputQuad->getVertex(1);
-    QPointF ic = inputQuad->getVertex(2);
-    QPointF id = inputQuad->getVertex(3);
+    const QPointF& ia = inputQuad[0];
+    const QPointF& ib = inputQuad[1];
+    const QPointF& ic = inputQuad[2];
+    const QPointF& id = inputQuad[3];
 
     QPointF outputV1 = oa-ob;
     QPointF outputV2 = oc-ob;
@@ -485,39 +675,17 @@ void MeshTextureGraphicsItem::_buildCacheQuadItem(CacheQuadItem& item, const Qua
   }
   else // subdivide
   {
-    QList<Quad::ptr> inputSubQuads  = _split(*inputQuad);
-    QList<Quad::ptr> outputSubQuads = _split(*outputQuad);
-    for (int i = 0; i < inputSubQuads.size(); i++)
+    QuadF inputSubQuads[4];
+    QuadF outputSubQuads[4];
+    inputQuad.split(inputSubQuads);
+    outputQuad.split(outputSubQuads);
+    for (int i = 0; i < 4; i++)
     {
       _buildCacheQuadItem(item, inputSubQuads[i], outputSubQuads[i], outputArea*0.25, inputThreshod, outputThreshold, minArea, (maxDepth == -1 ? -1 : maxDepth - 1));
     }
   }
 }
 
-QList<Quad::ptr> MeshTextureGraphicsItem::_split(const Quad& quad)
-{
-  QList<Quad::ptr> quads;
-
-  QPointF a = quad.getVertex(0);
-  QPointF b = quad.getVertex(1);
-  QPointF c = quad.getVertex(2);
-  QPointF d = quad.getVertex(3);
-
-  QPointF ab = (a + b) * 0.5f;
-  QPointF bc = (b + c) * 0.5f;
-  QPointF cd = (c + d) * 0.5f;
-  QPointF ad = (a + d) * 0.5f;
-
-  QPointF abcd = (ab + cd) * 0.5f;
-
-  quads.append(Quad::ptr(new Quad(a, ab, abcd, ad)));
-  quads.append(Quad::ptr(new Quad(ab, b, bc, abcd)));
-  quads.append(Quad::ptr(new Quad(abcd, bc, c, cd)));
-  quads.append(Quad::ptr(new Quad(ad, abcd, cd, d)));
-
-  return quads;
-}
-
 EllipseTextureGraphicsItem::DrawingData::DrawingData(const QSharedPointer<Ellipse>& ellipse)
 {
   // Gather basic definitions.
@@ -576,13 +744,12 @@ QRectF EllipseTextureGraphicsItem::boundingRect() const
   return shape().boundingRect();
 }
 
-void EllipseTextureGraphicsItem::_doDrawOutput(QPainter* painter)
+void EllipseTextureGraphicsItem::_appendOutputGeometry(TextureBatch& batch)
 {
-  Q_UNUSED(painter);
   // Get input and output ellipses.
   QSharedPointer<Ellipse> inputEllipse  = qSharedPointerCast<Ellipse>(_inputShape);
   QSharedPointer<Ellipse> outputEllipse = qSharedPointerCast<Ellipse>(_shape);
-  QSharedPointer<Texture> texture = _getTexture();
+  QSharedPointer<Texture> texture = getTexture();
 
   // Data for calculating drawing.
   DrawingData inputData(inputEllipse);
@@ -618,12 +785,10 @@ void EllipseTextureGraphicsItem::_doDrawOutput(QPainter* painter)
 
       if (j > 0) // We don't draw the first triangle.
       {
-        // Draw triangle.
-        glBegin(GL_TRIANGLES);
-        Util::setGlTexPoint(*texture, inputData.controlCenter, outputData.controlCenter);
-        Util::setGlTexPoint(*texture, prevInputPoint,     prevOutputPoint);
-        Util::setGlTexPoint(*texture, currentInputPoint,  currentOutputPoint);
-        glEnd();
+        // Add triangle.
+        batch.addTriangle(*texture,
+                          inputData.controlCenter,  prevInputPoint,  currentInputPoint,
+                          outputData.controlCenter, prevOutputPoint, currentOutputPoint);
       }
 
       // Save point for next iteration.
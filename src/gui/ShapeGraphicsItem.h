@@ -37,6 +37,7 @@
 #include "Paint.h"
 #include "Mapping.h"
 #include "MapperGLCanvas.h"
+#include "BatchRenderer.h"
 
 namespace mmp {
 
@@ -81,6 +82,9 @@ public:
   /// Returns whether the mapping this shape is associated should be visible.
   bool isMappingVisible() const;
 
+  /// Syncs item with mapping before painting and returns true iff it should be painted.
+  bool prepareToPaint();
+
   /// Returns the bounding rectangle of this item.
   virtual QRectF boundingRect() const { return shape().boundingRect(); }
 //  virtual QPainterPath shape() const;
@@ -116,13 +120,39 @@ class ColorGraphicsItem : public ShapeGraphicsItem
 {
 protected:
   ColorGraphicsItem(Mapping::ptr mapping, bool output=true)
-    : ShapeGraphicsItem(mapping, output) {}
+    : ShapeGraphicsItem(mapping, output), _tessellatedVersion(0) {}
 public:
   virtual ~ColorGraphicsItem() {}
 
+  /// Adds the output triangles of this item (with color and opacity applied) to batch.
+  void appendGeometry(ColorBatch& batch);
+
 protected:
   virtual void _prePaint(QPainter *painter,
                         const QStyleOptionGraphicsItem *option);
+
+  /**
+   * Tessellates the shape (done by subclasses): fills triangles (three points each) and
+   * outline (the contour of the shape), both in item coordinates.
+   */
+  virtual void _tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const = 0;
+
+private:
+  // Rebuilds the cached tessellation iff the shape changed.
+  void _updateTessellation();
+
+  // Builds the triangles of the antialiased (fading) edge around outline.
+  void _buildFringe(const QPolygonF& outline);
+
+  // Version of the shape when the cache was built.
+  quint64 _tessellatedVersion;
+
+  // Cached triangles of the shape.
+  QVector<QPointF> _triangles;
+
+  // Cached triangles of the antialiased edge and coverage of each of their vertices.
+  QVector<QPointF> _fringe;
+  QVector<GLfloat> _fringeCoverage;
 };
 
 /// Graphics item for colored polygons (eg. quad, triangle).
@@ -137,6 +167,7 @@ public:
 protected:
   virtual void _doPaint(QPainter *painter,
                         const QStyleOptionGraphicsItem *option);
+  virtual void _tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const;
 };
 
 /**
@@ -151,6 +182,7 @@ public:
 protected:
   virtual void _doPaint(QPainter *painter,
                         const QStyleOptionGraphicsItem *option);
+  virtual void _tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const;
 
 };
 
@@ -166,6 +198,7 @@ public:
 protected:
   virtual void _doPaint(QPainter *painter,
                         const QStyleOptionGraphicsItem *option);
+  virtual void _tessellate(QVector<QPointF>& triangles, QPolygonF& outline) const;
 };
 
 /// Abstract class for texture graphics items.
@@ -176,19 +209,49 @@ public:
 
   virtual ~TextureGraphicsItem() {}
 
+  /// Returns the texture (ie. the paint of the mapping).
+  QSharedPointer<Texture> getTexture() const;
+
+  /// Adds the output triangles of this item (with opacity applied) to batch.
+  void appendGeometry(TextureBatch& batch);
+
+  /// Binds texture, uploads its bits if needed and sets up blending and texture parameters.
+  static void bindTexture(const QSharedPointer<Texture>& texture);
+
+  /// Uploads bits of (already bound) texture if they changed and sets its parameters.
+  static void uploadTexture(const QSharedPointer<Texture>& texture);
+
 protected:
   virtual void _doPaint(QPainter *painter, const QStyleOptionGraphicsItem *option);
   void _prePaint(QPainter* painter, const QStyleOptionGraphicsItem *option);
   void _postPaint(QPainter* painter, const QStyleOptionGraphicsItem *option);
 
-  virtual void _doDrawOutput(QPainter* painter) = 0;
+  virtual void _doDrawOutput(QPainter* painter);
   virtual void _doDrawInput(QPainter* painter);
 
+  /// Adds the output triangles of this item to batch (done by subclasses).
+  virtual void _appendOutputGeometry(TextureBatch& batch) = 0;
+
+  /**
+   * Returns true iff the output geometry changed since it was last cached. By default
+   * compares the versions of the shapes and texture; can be overriden to add conditions.
+   */
+  virtual bool _outputGeometryChanged();
+
 protected:
   QWeakPointer<TextureMapping> _textureMapping;
   QWeakPointer<MShape> _inputShape;
 
-	QSharedPointer<Texture> _getTexture();
+private:
+  // Cached output geometry (built by _appendOutputGeometry()).
+  TextureBatch _cachedGeometry;
+  bool _hasCachedGeometry;
+
+  // Versions of shapes and texture when the cache was built.
+  quint64 _cachedInputVersion;
+  quint64 _cachedOutputVersion;
+  quint64 _cachedTextureVersion;
+  Texture* _cachedTexture;
 };
 
 /// Graphics item for textured polygons (eg. triangles).
@@ -210,7 +273,8 @@ public:
   TriangleTextureGraphicsItem(Mapping::ptr mapping, bool output=true) : PolygonTextureGraphicsItem(mapping, output) {}
   virtual ~TriangleTextureGraphicsItem(){}
 
-  virtual void _doDrawOutput(QPainter* painter);
+protected:
+  virtual void _appendOutputGeometry(TextureBatch& batch);
 
 };
 
@@ -224,33 +288,35 @@ class MeshTextureGraphicsItem : public PolygonTextureGraphicsItem
 {
   // Internal use (cache). A structure consisting of the input and output quads of mapping.
   struct CacheQuadMapping {
-    Quad::ptr input;
-    Quad::ptr output;
+    QuadF input;
+    QuadF output;
   };
 
   // Internal use (cache). Contains a parent mapping and all its sub-mappings.
   struct CacheQuadItem {
     CacheQuadMapping parent;
-    QList<CacheQuadMapping> subQuads;
+    QVector<CacheQuadMapping> subQuads;
   };
 public:
   MeshTextureGraphicsItem(Mapping::ptr mapping, bool output=true);
   virtual ~MeshTextureGraphicsItem(){}
 
-  virtual void _doDrawOutput(QPainter* painter);
+protected:
+  virtual void _appendOutputGeometry(TextureBatch& batch);
+  virtual bool _outputGeometryChanged();
 
 private:
+  // Returns true iff shape or one of its vertices is currently being grabbed.
+  bool _isGrabbing() const;
+
   /**
    * Builds cache item recursively using the technique described in
    * Oliveira, M. "Correcting Texture Mapping Errors Introduced by Graphics Hardware"
    */
-  void _buildCacheQuadItem(CacheQuadItem& item, const Quad::ptr& inputQuad, const Quad::ptr& outputQuad,
+  void _buildCacheQuadItem(CacheQuadItem& item, const QuadF& inputQuad, const QuadF& outputQuad,
                            float outputArea, float inputThreshold = 0.0001f, float outputThreshold = 0.001f,
                            int minArea=MM::MESH_SUBDIVISION_MIN_AREA, int maxDepth=-1);
 
-  // Help function that returns four equal-size sub-quads from a quad.
-  QList<Quad::ptr> _split(const Quad& quad);
-
   // Contains the current cache.
   QVector<QVector<CacheQuadItem> > _cachedQuadItems;
   int _nHorizontalQuads;
@@ -286,8 +352,10 @@ public:
   virtual QPainterPath shape() const;
   virtual QRectF boundingRect() const;
 
-  virtual void _doDrawOutput(QPainter* painter);
+protected:
+  virtual void _appendOutputGeometry(TextureBatch& batch);
 
+public:
   static void _setPointOfEllipseAtAngle(QPointF& point, const QPointF& center, float hRadius, float vRadius, float rotation, float circularAngle);
 };
 
@@ -0,0 +1,251 @@
+/*
+ * ShapeSpatialIndex.cpp
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ShapeSpatialIndex.h"
+
+#include "MainWindow.h"
+
+namespace mmp {
+
+ShapeSpatialIndex::ShapeSpatialIndex(bool output)
+  : _output(output),
+    _cellSize(MM::SPATIAL_INDEX_CELL_SIZE),
+    _isValid(false),
+    _managerVersion(0),
+    _shapesVersion(0),
+    _generation(0)
+{
+}
+
+Mapping::ptr ShapeSpatialIndex::getMappingAt(const QPointF& point)
+{
+  _update();
+
+  MappingManager& manager = MainWindow::window()->getMappingManager();
+
+  // Candidates are the shapes registered in the cell of point plus the large ones.
+  QVector<uid> candidates = _shapeCells.value(_cellKey(_cellCoordinate(point.x()), _cellCoordinate(point.y())));
+  for (QSet<uid>::const_iterator it = _largeShapes.constBegin(); it != _largeShapes.constEnd(); ++it)
+    candidates.append(*it);
+
+  // Keep the topmost visible one.
+  const ShapeEntry* top = 0;
+  for (uid mappingId: candidates)
+  {
+    const ShapeEntry& entry = _shapes[mappingId];
+    if ((!top || entry.layer > top->layer) &&
+        manager.mappingIsVisible(entry.mapping) &&
+        entry.shape->includesPoint(point))
+      top = &entry;
+  }
+
+  return (top ? top->mapping : Mapping::ptr());
+}
+
+int ShapeSpatialIndex::findVertex(const QPointF& point, qreal radius, MShape::ptr shape)
+{
+  const VertexEntry* vertex = _findNearest(point, radius,
+    [this, shape](const VertexEntry& v) { return _shapes[v.mappingId].shape == shape; });
+  return (vertex ? vertex->index : -1);
+}
+
+bool ShapeSpatialIndex::findNearestVertex(const QPointF& point, qreal radius, QPointF* vertex,
+                                          MShape::ptr excluded)
+{
+  const VertexEntry* nearest = _findNearest(point, radius,
+    [this, excluded](const VertexEntry& v) { return _shapes[v.mappingId].shape != excluded; });
+  if (nearest)
+    *vertex = nearest->point;
+  return (nearest != 0);
+}
+
+template<class Filter>
+const ShapeSpatialIndex::VertexEntry* ShapeSpatialIndex::_findNearest(const QPointF& point, qreal radius, Filter filter)
+{
+  _update();
+
+  // Look in all cells overlapping the square around the point.
+  const VertexEntry* nearest = 0;
+  qreal minDistance = sq(radius);
+  for (int column = _cellCoordinate(point.x() - radius); column <= _cellCoordinate(point.x() + radius); column++)
+    for (int row = _cellCoordinate(point.y() - radius); row <= _cellCoordinate(point.y() + radius); row++)
+    {
+      QHash<quint64, QVector<VertexEntry> >::const_iterator cell = _vertexCells.constFind(_cellKey(column, row));
+      if (cell == _vertexCells.constEnd())
+        continue;
+
+      for (const VertexEntry& v: *cell)
+      {
+        // Ties go to the lowest vertex index (as when going through vertices in order).
+        qreal distance = distSq(point, v.point);
+        bool closer = (distance < minDistance ||
+                       (nearest && distance == minDistance &&
+                        v.mappingId == nearest->mappingId && v.index < nearest->index));
+        if (closer && filter(v))
+        {
+          nearest = &v;
+          minDistance = distance;
+        }
+      }
+    }
+
+  return nearest;
+}
+
+void ShapeSpatialIndex::_update()
+{
+  MappingManager& manager = MainWindow::window()->getMappingManager();
+
+  // Nothing to do if no mapping nor shape changed since last time.
+  bool mappingsChanged = (!_isValid || manager.getVersion() != _managerVersion);
+  if (!mappingsChanged && MShape::getLastVersion() == _shapesVersion)
+    return;
+
+  // Register again shapes that changed.
+  _generation++;
+  for (int i=0; i<manager.nMappings(); i++)
+  {
+    Mapping::ptr mapping = manager.getMapping(i);
+    MShape::ptr shape = (_output ? mapping->getShape() : mapping->getInputShape());
+    if (shape.isNull())
+      continue;
+
+    uid mappingId = mapping->getId();
+    QHash<uid, ShapeEntry>::iterator it = _shapes.find(mappingId);
+    if (it == _shapes.end())
+    {
+      it = _shapes.insert(mappingId, ShapeEntry());
+      it->mapping = mapping;
+      it->shape = shape;
+      _insert(mappingId, *it);
+    }
+    else if (it->mapping != mapping || it->shape != shape || it->version != shape->getVersion())
+    {
+      _remove(mappingId, *it);
+      it->mapping = mapping;
+      it->shape = shape;
+      _insert(mappingId, *it);
+    }
+
+    it->layer = i;
+    it->generation = _generation;
+  }
+
+  // Remove mappings that are gone.
+  if (mappingsChanged)
+  {
+    for (QHash<uid, ShapeEntry>::iterator it = _shapes.begin(); it != _shapes.end(); )
+    {
+      if (it->generation != _generation)
+      {
+        _remove(it.key(), *it);
+        it = _shapes.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  _isValid = true;
+  _managerVersion = manager.getVersion();
+  _shapesVersion = MShape::getLastVersion();
+}
+
+void ShapeSpatialIndex::_insert(uid mappingId, ShapeEntry& entry)
+{
+  entry.version = entry.shape->getVersion();
+
+  // Register shape in cells covered by its bounding rectangle.
+  QRectF rect = entry.shape->getBoundingRect();
+  int left   = _cellCoordinate(rect.left());
+  int right  = _cellCoordinate(rect.right());
+  int top    = _cellCoordinate(rect.top());
+  int bottom = _cellCoordinate(rect.bottom());
+
+  entry.cells.clear();
+  entry.isLarge = (qreal(right - left + 1) * (bottom - top + 1) > MM::SPATIAL_INDEX_MAX_SHAPE_CELLS);
+  if (entry.isLarge)
+    _largeShapes.insert(mappingId);
+  else
+  {
+    for (int column = left; column <= right; column++)
+      for (int row = top; row <= bottom; row++)
+      {
+        quint64 key = _cellKey(column, row);
+        _shapeCells[key].append(mappingId);
+        entry.cells.append(key);
+      }
+  }
+
+  // Register vertices.
+  entry.vertexCells.clear();
+  const QVector<QPointF>& vertices = entry.shape->getVertices();
+  for (int i=0; i<vertices.size(); i++)
+  {
+    quint64 key = _cellKey(_cellCoordinate(vertices[i].x()), _cellCoordinate(vertices[i].y()));
+    QVector<VertexEntry>& cell = _vertexCells[key];
+    // Only this shape adds vertices to cells meanwhile: check if it already did for that one.
+    if (cell.isEmpty() || cell.last().mappingId != mappingId)
+      entry.vertexCells.append(key);
+
+    VertexEntry vertex;
+    vertex.point = vertices[i];
+    vertex.mappingId = mappingId;
+    vertex.index = i;
+    cell.append(vertex);
+  }
+}
+
+void ShapeSpatialIndex::_remove(uid mappingId, ShapeEntry& entry)
+{
+  if (entry.isLarge)
+    _largeShapes.remove(mappingId);
+
+  for (quint64 key: entry.cells)
+  {
+    QHash<quint64, QVector<uid> >::iterator cell = _shapeCells.find(key);
+    if (cell == _shapeCells.end())
+      continue;
+    cell->removeAll(mappingId);
+    if (cell->isEmpty())
+      _shapeCells.erase(cell);
+  }
+
+  for (quint64 key: entry.vertexCells)
+  {
+    QHash<quint64, QVector<VertexEntry> >::iterator cell = _vertexCells.find(key);
+    if (cell == _vertexCells.end())
+      continue;
+
+    QVector<VertexEntry>& vertices = *cell;
+    int n = 0;
+    for (int i=0; i<vertices.size(); i++)
+      if (vertices[i].mappingId != mappingId)
+        vertices[n++] = vertices[i];
+    vertices.resize(n);
+
+    if (vertices.isEmpty())
+      _vertexCells.erase(cell);
+  }
+
+  entry.cells.clear();
+  entry.vertexCells.clear();
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ * ShapeSpatialIndex.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAPE_SPATIAL_INDEX_H_
+#define SHAPE_SPATIAL_INDEX_H_
+
+#include <QHash>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+#include <QtMath>
+
+#include "MappingManager.h"
+
+namespace mmp {
+
+/**
+ * Uniform grid over the shapes of all mappings (either their output or their input shapes)
+ * and their vertices, used by canvases for hit-testing and vertex snapping.
+ *
+ * Each shape is registered in the cells covered by its bounding rectangle and each vertex
+ * in the cell that contains it, so that queries only look at the few shapes and vertices
+ * that are near the queried point. The index synchronizes itself with the mapping manager
+ * before each query: nothing is done unless mappings were added, removed or reordered or a
+ * shape was modified, and only modified shapes are then registered again.
+ */
+class ShapeSpatialIndex
+{
+public:
+  /// Indexes output shapes if output is true, input shapes otherwise.
+  ShapeSpatialIndex(bool output);
+
+  /// Returns the topmost visible mapping whose shape includes point (or null if there is none).
+  Mapping::ptr getMappingAt(const QPointF& point);
+
+  /**
+   * Returns the index of the vertex of shape closest to point, provided it lies
+   * within radius (returns -1 otherwise).
+   */
+  int findVertex(const QPointF& point, qreal radius, MShape::ptr shape);
+
+  /**
+   * Looks for the vertex closest to point within radius among all shapes but excluded one.
+   * Returns true and copies it to vertex if there is one.
+   */
+  bool findNearestVertex(const QPointF& point, qreal radius, QPointF* vertex,
+                         MShape::ptr excluded = MShape::ptr());
+
+private:
+  // A vertex registered in a cell.
+  struct VertexEntry
+  {
+    QPointF point;
+    uid mappingId;
+    int index;
+  };
+
+  // A shape registered in the index.
+  struct ShapeEntry
+  {
+    Mapping::ptr mapping;
+    MShape::ptr shape;
+    quint64 version;
+    int layer;
+    quint64 generation;
+    bool isLarge;
+    QVector<quint64> cells;
+    QVector<quint64> vertexCells;
+  };
+
+  // Registers the shape of mapping again if it changed and removes mappings that disappeared.
+  void _update();
+
+  // Adds entry to the cells it covers / removes it from them.
+  void _insert(uid mappingId, ShapeEntry& entry);
+  void _remove(uid mappingId, ShapeEntry& entry);
+
+  // Returns key of the cell containing point.
+  quint64 _cellKey(int column, int row) const { return (quint64(quint32(column)) << 32) | quint32(row); }
+  int _cellCoordinate(qreal x) const { return qFloor(x / _cellSize); }
+
+  // Returns the vertex closest to point within radius among vertices accepted by filter.
+  template<class Filter>
+  const VertexEntry* _findNearest(const QPointF& point, qreal radius, Filter filter);
+
+  bool _output;
+  qreal _cellSize;
+
+  // Versions of manager and shapes when index was last synchronized.
+  bool _isValid;
+  quint64 _managerVersion;
+  quint64 _shapesVersion;
+  quint64 _generation;
+
+  QHash<uid, ShapeEntry> _shapes;
+  QHash<quint64, QVector<uid> > _shapeCells;
+  QHash<quint64, QVector<VertexEntry> > _vertexCells;
+
+  // Shapes too large to be registered in cells (always tested).
+  QSet<uid> _largeShapes;
+};
+
+}
+
+#endif /* SHAPE_SPATIAL_INDEX_H_ */
@@ -5,7 +5,11 @@ include($$PWD/contrib/qtpropertybrowser/src/qtpropertybrowser.pri)
 include($$PWD/contrib/qtpropertybrowser-extension/qtpropertybrowser-extension.pri)
 
 HEADERS += $$PWD/AboutDialog.h \
+    $$PWD/BatchRenderer.h \
+    $$PWD/Compositor.h \
     $$PWD/ConsoleWindow.h \
+    $$PWD/FrameClock.h \
+    $$PWD/FrameReader.h \
     $$PWD/GuiForward.h \
     $$PWD/MainWindow.h \
     $$PWD/MapperGLCanvas.h \
@@ -13,24 +17,34 @@ HEADERS += $$PWD/AboutDialog.h \
     $$PWD/MappingGui.h \
     $$PWD/MappingItemDelegate.h \
     $$PWD/MappingListModel.h \
+    $$PWD/NativeRenderer.h \
+    $$PWD/OutputCorrectionDialog.h \
     $$PWD/OutputGLCanvas.h \
     $$PWD/OutputGLWindow.h \
     $$PWD/PaintGui.h \
     $$PWD/PreferenceDialog.h \
     $$PWD/ShapeControlPainter.h \
-    $$PWD/ShapeGraphicsItem.h
+    $$PWD/ShapeGraphicsItem.h \
+    $$PWD/ShapeSpatialIndex.h
 
 SOURCES += $$PWD/AboutDialog.cpp \
+    $$PWD/BatchRenderer.cpp \
+    $$PWD/Compositor.cpp \
     $$PWD/ConsoleWindow.cpp \
+    $$PWD/FrameClock.cpp \
+    $$PWD/FrameReader.cpp \
     $$PWD/MainWindow.cpp \
     $$PWD/MapperGLCanvas.cpp \
     $$PWD/MapperGLCanvasToolbar.cpp \
     $$PWD/MappingGui.cpp \
     $$PWD/MappingItemDelegate.cpp \
     $$PWD/MappingListModel.cpp \
+    $$PWD/NativeRenderer.cpp \
+    $$PWD/OutputCorrectionDialog.cpp \
     $$PWD/OutputGLCanvas.cpp \
     $$PWD/OutputGLWindow.cpp \
     $$PWD/PaintGui.cpp \
     $$PWD/PreferenceDialog.cpp \
     $$PWD/ShapeControlPainter.cpp \
-    $$PWD/ShapeGraphicsItem.cpp
+    $$PWD/ShapeGraphicsItem.cpp \
+    $$PWD/ShapeSpatialIndex.cpp
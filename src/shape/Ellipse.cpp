@@ -19,6 +19,8 @@
 
 #include "Ellipse.h"
 
+#include <QtMath>
+
 namespace mmp {
 
 void Ellipse::sanitize()
@@ -73,6 +75,21 @@ bool Ellipse::includesPoint(qreal x, qreal y)
   return (QVector2D(toUnitCircle().map(QPointF(x, y))).length() <= 1);
 }
 
+QRectF Ellipse::getBoundingRect() const
+{
+  // Extents of the ellipse along each axis, given its (rotated) half axes.
+  QVector2D hAxis = getHorizontalAxis() / 2;
+  QVector2D vAxis = getVerticalAxis() / 2;
+  qreal halfWidth  = qSqrt(hAxis.x()*hAxis.x() + vAxis.x()*vAxis.x());
+  qreal halfHeight = qSqrt(hAxis.y()*hAxis.y() + vAxis.y()*vAxis.y());
+
+  const QPointF& center = getCenter();
+  QRectF rect(center.x() - halfWidth, center.y() - halfHeight, 2*halfWidth, 2*halfHeight);
+
+  // Include control points (eg. the center control).
+  return rect.united(MShape::getBoundingRect());
+}
+
 void Ellipse::setVertex(int i, const QPointF& v)
 {
   // Save vertical axis vector.
@@ -129,6 +129,8 @@ public:
     return includesPoint(p.x(), p.y());
   }
 
+  virtual QRectF getBoundingRect() const;
+
   // Override the parent, checking to make sure the vertices are displaced correctly.
   virtual void setVertex(int i, const QPointF& v);
 
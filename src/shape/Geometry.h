@@ -0,0 +1,99 @@
+/*
+ * Geometry.h
+ *
+ * (c) 2016 Sofian Audry -- info(@)sofianaudry(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEOMETRY_H_
+#define GEOMETRY_H_
+
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+
+/**
+ * Lightweight geometry for rendering paths.
+ *
+ * Shapes (see MShape) are QObjects held by shared pointers, which is what
+ * properties and serialization need but makes temporaries expensive. The types
+ * below are plain fixed-size values: they live on the stack or inline in
+ * containers, and are cheap to copy and compare.
+ */
+
+namespace mmp {
+
+/// Four points in clockwise order (same order as Quad).
+struct QuadF
+{
+  QPointF p[4];
+
+  QuadF() {}
+  QuadF(const QPointF& a, const QPointF& b, const QPointF& c, const QPointF& d)
+  {
+    p[0] = a; p[1] = b; p[2] = c; p[3] = d;
+  }
+
+  const QPointF& operator[](int i) const { return p[i]; }
+  QPointF& operator[](int i) { return p[i]; }
+
+  bool operator==(const QuadF& q) const
+  {
+    return (p[0] == q.p[0] && p[1] == q.p[1] && p[2] == q.p[2] && p[3] == q.p[3]);
+  }
+  bool operator!=(const QuadF& q) const { return !(*this == q); }
+
+  QPolygonF toPolygon() const
+  {
+    QPolygonF polygon(4);
+    for (int i=0; i<4; i++)
+      polygon[i] = p[i];
+    return polygon;
+  }
+
+  QRectF boundingRect() const
+  {
+    qreal left = p[0].x(), right = p[0].x(), top = p[0].y(), bottom = p[0].y();
+    for (int i=1; i<4; i++)
+    {
+      left   = qMin(left,   p[i].x());
+      right  = qMax(right,  p[i].x());
+      top    = qMin(top,    p[i].y());
+      bottom = qMax(bottom, p[i].y());
+    }
+    return QRectF(left, top, right - left, bottom - top);
+  }
+
+  /// Splits in four equal-size sub-quads at the middle of the sides (same orientation as this quad).
+  void split(QuadF subQuads[4]) const
+  {
+    QPointF ab = (p[0] + p[1]) * 0.5f;
+    QPointF bc = (p[1] + p[2]) * 0.5f;
+    QPointF cd = (p[2] + p[3]) * 0.5f;
+    QPointF ad = (p[0] + p[3]) * 0.5f;
+    QPointF abcd = (ab + cd) * 0.5f;
+
+    subQuads[0] = QuadF(p[0], ab,   abcd, ad);
+    subQuads[1] = QuadF(ab,   p[1], bc,   abcd);
+    subQuads[2] = QuadF(abcd, bc,   p[2], cd);
+    subQuads[3] = QuadF(ad,   abcd, cd,   p[3]);
+  }
+};
+
+}
+
+Q_DECLARE_TYPEINFO(mmp::QuadF, Q_MOVABLE_TYPE);
+
+#endif /* GEOMETRY_H_ */
@@ -47,17 +47,10 @@ Mesh::Mesh(const QVector<QPointF>& points, int nColumns, int nRows) : Quad()
 
 void Mesh::build()
 {
-  // Resize the vertices2d vector to appropriate dimensions.
-  resizeVertices2d(_vertices2d, _nColumns, _nRows);
+  Q_ASSERT(vertices.size() == _nColumns * _nRows);
 
-  // Just build vertices2d in the standard order.
-  int k = 0;
-  for (int y=0; y<_nRows; y++)
-    for (int x=0; x<_nColumns; x++)
-    {
-      _vertices2d[x][y] = k;
-      k++;
-    }
+  // Vertex layout changed.
+  _bumpVersion();
 }
 
 void Mesh::init(const QVector<QPointF>& points, int nColumns, int nRows)
@@ -140,138 +133,14 @@ bool Mesh::isMajorVertex(int idx) const
 }
 
 
-void Mesh::resizeVertices2d(IndexVector2d& vertices2d, int nColumns, int nRows)
-{
-  vertices2d.resize(nColumns);
-  for (int i=0; i<nColumns; i++)
-    vertices2d[i].resize(nRows);
-}
-
-//void Mesh::init(int nColumns, int nRows)
-//{
-//  // Create vertices correspondence of bouding quad.
-//  resizeVertices2d(_vertices2d, 2, 2);
-//  _vertices2d[0][0] = 0;
-//  _vertices2d[1][0] = 1;
-//  _vertices2d[1][1] = 2;
-//  _vertices2d[0][1] = 3;
-//
-//  // Init number of columns and rows.
-//  _nColumns = _nRows = 2;
-//
-//  // Add extra columns and rows.
-//  for (int i=0; i<nColumns-2; i++)
-//    addColumn();
-//  for (int i=0; i<nRows-2; i++)
-//    addRow();
-//}
-
-// vertices 0..3 = 4 corners
-//
 void Mesh::addColumn()
 {
-  // Create new vertices 2d (temporary).
-  IndexVector2d newVertices2d;
-  resizeVertices2d(newVertices2d, nColumns()+1, nRows());
-
-  // Left displacement of points already there.
-  qreal leftMoveProp = 1.0f/(nColumns()-1) - 1.0f/nColumns();
-
-  // Add a point at each row.
-  int k = nVertices();
-  for (int y=0; y<nRows(); y++)
-  {
-    // Get left and right vertices.
-    QPointF left  = getVertex2d( 0,            y );
-    QPointF right = getVertex2d( nColumns()-1, y );
-    QPointF diff  = right - left;
-
-    // First pass: move middle points.
-    for (int x=1; x<nColumns()-1; x++)
-    {
-      QPointF p = getVertex2d(x, y);
-      p -= diff * x * leftMoveProp;
-      _rawSetVertex( _vertices2d[x][y], p );
-    }
-
-    // Create and add new point.
-    QPointF newPoint = right - diff * 1.0f/nColumns();
-    _addVertex(newPoint);
-
-    // Assign new vertices 2d.
-    for (int x=0; x<nColumns()-1; x++)
-      newVertices2d[x][y] = _vertices2d[x][y];
-
-    // The new point.
-    newVertices2d[nColumns()-1][y] = k;
-
-    // The rightmost point.
-    newVertices2d[nColumns()][y]   = _vertices2d[nColumns()-1][y];
-
-    k++;
-  }
-
-  // Copy new mapping.
-  _vertices2d = newVertices2d;
-
-  // Increment number of columns.
-  _nColumns++;
-
-  // Reorder.
-  _reorderVertices();
+  resize(nColumns()+1, nRows());
 }
 
 void Mesh::addRow()
 {
-  // Create new vertices 2d (temporary).
-  IndexVector2d newVertices2d;
-  resizeVertices2d(newVertices2d, nColumns(), nRows()+1);
-
-  // Top displacement of points already there.
-  qreal topMoveProp = 1.0f/(nRows()-1) - 1.0f/nRows();
-
-  // Add a point at each row.
-  int k = nVertices();
-  for (int x=0; x<nColumns(); x++)
-  {
-    // Get left and right vertices.
-    QPointF top    = getVertex2d(x, 0);
-    QPointF bottom = getVertex2d(x, nRows()-1);
-    QPointF diff   = bottom - top;
-
-    // First pass: move middle points.
-    for (int y=1; y<nRows()-1; y++)
-    {
-      QPointF p = getVertex2d(x, y);
-      p -= diff * y * topMoveProp;
-      _rawSetVertex( _vertices2d[x][y], p );
-    }
-
-    // Create and add new point.
-    QPointF newPoint = bottom - diff * 1.0f/nRows();
-    _addVertex(newPoint);
-
-    // Assign new vertices 2d.
-    for (int y=0; y<nRows()-1; y++)
-      newVertices2d[x][y] = _vertices2d[x][y];
-
-    // The new point.
-    newVertices2d[x][nRows()-1] = k;
-
-    // The rightmost point.
-    newVertices2d[x][nRows()]   = _vertices2d[x][nRows()-1];
-
-    k++;
-  }
-
-  // Copy new mapping.
-  _vertices2d = newVertices2d;
-
-  // Increment number of columns.
-  _nRows++;
-
-  // Reorder.
-  _reorderVertices();
+  resize(nColumns(), nRows()+1);
 }
 
 void Mesh::removeColumn(int columnId)
@@ -279,10 +148,6 @@ void Mesh::removeColumn(int columnId)
   // Cannot remove first and last columns
   Q_ASSERT(columnId >= 1 && columnId < nColumns()-1);
 
-  // Temporary containers that will be used to rebuild new vertex space.
-  IndexVector2d newVertices2d;
-  resizeVertices2d(newVertices2d, nColumns()-1, nRows());
-
   QVector<QPointF> newVertices(vertices.size()-nRows());
 
   // Right displacement of points already there.
@@ -316,22 +181,17 @@ void Mesh::removeColumn(int columnId)
         p += (x < columnId ? +1 : -1) * diff * newX * rightMoveProp;
       }
 
-      // Assign new containers.
-      newVertices[k]         = p;
-      newVertices2d[newX][y] = k;
-      k++;
+      // Vertices are added in the new row-major order.
+      newVertices[k++] = p;
     }
   }
 
-  // Copy new mapping.
-  vertices    = newVertices;
-  _vertices2d = newVertices2d;
+  // Copy new vertices.
+  vertices = newVertices;
 
   // Decrement number of columns.
   _nColumns--;
-
-  // Reorder.
-  _reorderVertices();
+  _bumpVersion();
 }
 
 void Mesh::removeRow(int rowId)
@@ -339,135 +199,98 @@ void Mesh::removeRow(int rowId)
   // Cannot remove first and last columns
   Q_ASSERT(rowId >= 1 && rowId < nRows()-1);
 
-  // Temporary containers that will be used to rebuild new vertex space.
-  IndexVector2d newVertices2d;
-  resizeVertices2d(newVertices2d, nColumns(), nRows()-1);
-
   QVector<QPointF> newVertices(vertices.size()-nColumns());
 
   // Bottom displacement of points already there.
   qreal bottomMoveProp = 1.0f/(nRows()-2) - 1.0f/(nRows()-1);
 
-  // Process all columns.
+  // Process all rows.
   int k = 0;
-  for (int x=0; x<nColumns(); x++)
+  for (int y=0; y<nRows(); y++)
   {
-    // Get top and bottom vertices.
-    QPointF top    = getVertex2d(x, 0);
-    QPointF bottom = getVertex2d(x, nRows()-1);
-    QPointF diff   = bottom - top;
+    // Ignore points from target row.
+    if (y == rowId)
+      continue;
 
-    // Move all rows.
-    for (int y=0; y<nRows(); y++)
-    {
-      // Ignore points from target row.
-      if (y == rowId)
-        continue;
+    // The y value of this point in the new space.
+    int newY = y < rowId ? y : y-1;
 
+    for (int x=0; x<nColumns(); x++)
+    {
       // Get current vertex.
       QPointF p = getVertex2d( x, y );
 
-      // The y value of this point in the new space.
-      int newY = y < rowId ? y : y-1;
-
-      // Move middle points.
+      // Move middle points (along their column).
       if (y > 0 && y < nRows()-1)
       {
+        QPointF diff = getVertex2d(x, nRows()-1) - getVertex2d(x, 0);
         p += (y < rowId ? +1 : -1) * diff * newY * bottomMoveProp;
       }
 
-      // Assign new containers.
-      newVertices[k]         = p;
-      newVertices2d[x][newY] = k;
-      k++;
+      // Vertices are added in the new row-major order.
+      newVertices[k++] = p;
     }
   }
 
-  // Copy new mapping.
-  vertices    = newVertices;
-  _vertices2d = newVertices2d;
+  // Copy new vertices.
+  vertices = newVertices;
 
   // Decrement number of rows.
   _nRows--;
-
-  // Reorder.
-  _reorderVertices();
+  _bumpVersion();
 }
 
-
 void Mesh::resize(int nColumns_, int nRows_)
 {
-  // Brutal: if asked to reduce columns or rows, just delete and redo.
-  if (nColumns_ < nColumns())
-  {
-    while (nColumns_ != nColumns())
-      removeColumn(nColumns()-2);
-  }
-  if (nRows_ < nRows())
+  Q_ASSERT(nColumns_ >= 2 && nRows_ >= 2);
+  if (nColumns_ == nColumns() && nRows_ == nRows())
+    return;
+
+  // Cell of the current mesh each new column falls in (and position within it).
+  QVector<int>   cellColumns(nColumns_);
+  QVector<qreal> columnFactors(nColumns_);
+  for (int x=0; x<nColumns_; x++)
   {
-    while (nRows_ != nRows())
-      removeRow(nRows()-2);
+    qreal position = qreal(x * (nColumns()-1)) / (nColumns_-1);
+    cellColumns[x]   = qMin(int(position), nColumns()-2);
+    columnFactors[x] = position - cellColumns[x];
   }
-  if (nColumns_ > nColumns())
-  {
-    while (nColumns_ != nColumns())
-      addColumn();
-  }
-  if (nRows_ > nRows())
-  {
-    while (nRows_ != nRows())
-      addRow();
-  }
-}
 
-QVector<Quad::ptr> Mesh::getQuads() const
-{
-  QVector<Quad::ptr> quads;
-  for (int i=0; i<nHorizontalQuads(); i++)
+  // Same for rows.
+  QVector<int>   cellRows(nRows_);
+  QVector<qreal> rowFactors(nRows_);
+  for (int y=0; y<nRows_; y++)
   {
-    for (int j=0; j<nVerticalQuads(); j++)
-    {
-      quads.push_back(Quad::ptr(
-          new Quad(
-                      getVertex2d(i,   j  ),
-                      getVertex2d(i+1, j  ),
-                      getVertex2d(i+1, j+1),
-                      getVertex2d(i,   j+1)
-                  )
-      ));
-    }
+    qreal position = qreal(y * (nRows()-1)) / (nRows_-1);
+    cellRows[y]   = qMin(int(position), nRows()-2);
+    rowFactors[y] = position - cellRows[y];
   }
 
-  return quads;
-}
-
-QVector< QVector<Quad::ptr> > Mesh::getQuads2d() const
-{
-  QVector< QVector<Quad::ptr> > quads2d;
-  for (int i=0; i<nHorizontalQuads(); i++)
+  // Interpolate new vertices from the corners of their cell.
+  QVector<QPointF> newVertices(nColumns_ * nRows_);
+  int k = 0;
+  for (int y=0; y<nRows_; y++)
   {
-    QVector<Quad::ptr> column;
-    for (int j=0; j<nVerticalQuads(); j++)
+    int   row = cellRows[y];
+    qreal v   = rowFactors[y];
+    for (int x=0; x<nColumns_; x++)
     {
-      column.push_back(Quad::ptr(
-          new Quad(
-                      getVertex2d(i,   j  ),
-                      getVertex2d(i+1, j  ),
-                      getVertex2d(i+1, j+1),
-                      getVertex2d(i,   j+1)
-                  )
-      ));
+      int   column = cellColumns[x];
+      qreal u      = columnFactors[x];
+      QPointF top    = getVertex2d(column, row)   * (1-u) + getVertex2d(column+1, row)   * u;
+      QPointF bottom = getVertex2d(column, row+1) * (1-u) + getVertex2d(column+1, row+1) * u;
+      newVertices[k++] = top * (1-v) + bottom * v;
     }
-    quads2d.push_back(column);
   }
-  return quads2d;
+
+  vertices  = newVertices;
+  _nColumns = nColumns_;
+  _nRows    = nRows_;
+  _bumpVersion();
 }
 
 void Mesh::copyFrom(const MShape& shape)
 {
-  // This will copy vertices.
-  MShape::copyFrom(shape);
-
   // Cast to mesh.
   const Mesh* mesh = static_cast<const Mesh*>(&shape);
   Q_ASSERT(mesh);
@@ -475,34 +298,8 @@ void Mesh::copyFrom(const MShape& shape)
   _nColumns = mesh->_nColumns;
   _nRows    = mesh->_nRows;
 
-  // Deep copy vertices2d.
-  _vertices2d.resize(_nColumns);
-  for (int i=0; i<_nColumns; i++)
-  {
-    _vertices2d[i].resize(_nRows);
-    qCopy(mesh->_vertices2d[i].begin(), mesh->_vertices2d[i].end(), _vertices2d[i].begin());
-  }
-
-	_reorderVertices();
-}
-
-void Mesh::_reorderVertices()
-{
-  // Populate new vertices vector.
-  QVector<QPointF> newVertices(vertices.size());
-  int k = 0;
-  for (int y=0; y<nRows(); y++)
-    for (int x=0; x<nColumns(); x++)
-      newVertices[k++] = getVertex2d( x, y );
-
-  // Populate _vertices2d.
-  k = 0;
-  for (int y=0; y<nRows(); y++)
-    for (int x=0; x<nColumns(); x++)
-      _vertices2d[x][y] = k++;
-
-  // Copy.
-  vertices = newVertices;
+  // This will copy vertices (already in the same order).
+  MShape::copyFrom(shape);
 }
 
 }
@@ -22,6 +22,7 @@
 #define MESH_H_
 
 #include "Quad.h"
+#include "Geometry.h"
 
 namespace mmp {
 
@@ -32,8 +33,6 @@ class Mesh : public Quad
   Q_PROPERTY(int nColumns READ nColumns WRITE setNColumns)
   Q_PROPERTY(int nRows    READ nRows    WRITE setNRows)
 
-  typedef QVector<QVector<int> > IndexVector2d;
-
 public:
   Q_INVOKABLE Mesh();
 
@@ -64,32 +63,42 @@ public:
 
   QPointF getVertex2d(int i, int j) const
   {
-    return vertices[_vertices2d[i][j]];
+    return vertices[_vertexIndex(i, j)];
   }
 
   void setVertex2d(int i, int j, const QPointF& v)
   {
-    vertices[_vertices2d[i][j]] = v; // copy
+    _rawSetVertex(_vertexIndex(i, j), v);
   }
 
   void setVertex2d(int i, int j, double x, double y)
   {
-    vertices[_vertices2d[i][j]] = QPointF(x, y);
+    _rawSetVertex(_vertexIndex(i, j), QPointF(x, y));
   }
 
-  void resizeVertices2d(IndexVector2d& vertices2d, int nColumns, int nRows);
-
-  //
+  /// Adds one column/row (see resize()).
   void addColumn();
   void addRow();
 
+  /// Removes a middle column/row, moving the remaining ones to keep them evenly spread.
   void removeColumn(int columnId);
   void removeRow(int rowId);
 
+  /**
+   * Changes the number of columns and rows by resampling the mesh: each new vertex
+   * is interpolated (bilinearly) from the cell of the current mesh it falls in, so
+   * that the contour and deformations of the mesh are preserved. Runs in one pass.
+   */
   void resize(int nColumns_, int nRows_);
 
-  QVector<Quad::ptr> getQuads() const;
-  QVector<QVector<Quad::ptr> > getQuads2d() const;
+  /// Returns the quad of cell (i, j) (i < nHorizontalQuads(), j < nVerticalQuads()) read straight from the vertices.
+  QuadF getCell(int i, int j) const
+  {
+    return QuadF(getVertex2d(i,   j  ),
+                 getVertex2d(i+1, j  ),
+                 getVertex2d(i+1, j+1),
+                 getVertex2d(i,   j+1));
+  }
 
   int nColumns() const { return _nColumns; }
   int nRows() const  { return _nRows; }
@@ -109,11 +118,10 @@ public:
 protected:
   int _nColumns;
   int _nRows;
-  // _vertices[i][j] contains vertex id of vertex at position (i,j) where i = 0..nColumns and j = 0..nRows
-  IndexVector2d _vertices2d;
 
   /**
-   * Reorder vertices in a standard order:
+   * Returns the index of vertex at position (i,j) where i = 0..nColumns and j = 0..nRows.
+   * Vertices are stored row by row:
    *
    * 0----1----2----3
    * |    |    |    |
@@ -121,7 +129,7 @@ protected:
    * |    |    |    |
    * 8----9---10----11
    */
-  void _reorderVertices();
+  int _vertexIndex(int i, int j) const { return j*_nColumns + i; }
 
   /// Returns a new MShape (using default constructor).
   virtual MShape* _create() const { return new Mesh(); }
@@ -19,15 +19,99 @@
 
 #include "Polygon.h"
 
+#include <QtNumeric>
+
 namespace mmp {
 
+// Returns the bounding box of a line segment.
+static QRectF _segmentBounds(const QLineF& segment)
+{
+  return QRectF(QPointF(qMin(segment.x1(), segment.x2()), qMin(segment.y1(), segment.y2())),
+                QPointF(qMax(segment.x1(), segment.x2()), qMax(segment.y1(), segment.y2())));
+}
+
+// Returns true iff segment coordinates are all finite (non-finite segments never intersect).
+static bool _segmentIsFinite(const QLineF& segment)
+{
+  return qIsFinite(segment.x1()) && qIsFinite(segment.y1()) &&
+         qIsFinite(segment.x2()) && qIsFinite(segment.y2());
+}
+
+// Returns true iff the two rectangles overlap (borders included).
+static bool _boundsOverlap(const QRectF& a, const QRectF& b)
+{
+  return a.left() <= b.right() && b.left() <= a.right() &&
+         a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+// Returns the area where an adjunct segment or the original-to-new vertex line can intersect
+// other segments, made a little larger to cope with approximation errors.
+static QRectF _searchBounds(const QLineF& adjunct, const QRectF& originalToNewBounds, qreal margin)
+{
+  QRectF bounds = originalToNewBounds;
+  if (_segmentIsFinite(adjunct))
+  {
+    // NOTE: QRectF::united() cannot be used as it ignores empty rectangles.
+    const QRectF& adjunctBounds = _segmentBounds(adjunct);
+    bounds.setCoords(qMin(bounds.left(),  adjunctBounds.left()),  qMin(bounds.top(),    adjunctBounds.top()),
+                     qMax(bounds.right(), adjunctBounds.right()), qMax(bounds.bottom(), adjunctBounds.bottom()));
+  }
+  return bounds.adjusted(-margin, -margin, margin, margin);
+}
+
 void Polygon::setVertex(int i, const QPointF& v)
 {
+  QPolygonF polygon = toPolygon();
+
   // Constrain vertex.
   QPointF realV = v;
-  _constrainVertex(toPolygon(), i, realV);
+  if (polygon.size() > 3)
+  {
+    _updateConstraintSegments(polygon);
+    _constrainVertex(polygon, _constraintSegments, _constraintSegmentBounds, i, realV);
+  }
+
   // Really set the vertex.
   _rawSetVertex(i, realV);
+
+  // Only the two segments adjacent to the vertex have changed.
+  if (polygon.size() > 3)
+  {
+    polygon[i] = realV;
+    _updateConstraintSegment(polygon, wrapAround(i - 1, polygon.size()));
+    _updateConstraintSegment(polygon, i);
+    _constraintSegmentsVersion = getVersion();
+  }
+}
+
+void Polygon::_updateConstraintSegments(const QPolygonF& polygon)
+{
+  if (_constraintSegmentsVersion == getVersion() &&
+      _constraintSegments.size() == polygon.size())
+    return;
+
+  _constraintSegments.resize(polygon.size());
+  _constraintSegmentBounds.resize(polygon.size());
+  for (int i=0; i<polygon.size(); i++)
+    _updateConstraintSegment(polygon, i);
+  _constraintSegmentsVersion = getVersion();
+}
+
+void Polygon::_updateConstraintSegment(const QPolygonF& polygon, int i)
+{
+  QLineF segment = _getConstraintSegment(polygon.at(i), polygon.at( (i+1) % polygon.size() ));
+  _constraintSegments[i]      = segment;
+  _constraintSegmentBounds[i] = _segmentBounds(segment);
+}
+
+QLineF Polygon::_getConstraintSegment(const QPointF& p1, const QPointF& p2)
+{
+  // Create small vector pointing in same direction as segment.
+  QVector2D vec(p2 - p1);
+  vec *= _CONSTRAIN_VERTEX_SEGMENT_ELONGATION / vec.length();
+  QPointF diff = vec.toPointF();
+  // Use it to elongate segment slightly.
+  return QLineF(p1 - diff, p2 + diff);
 }
 
 void Polygon::_constrainVertex(const QPolygonF& polygon, int i, QPointF& v)
@@ -36,41 +120,53 @@ void Polygon::_constrainVertex(const QPolygonF& polygon, int i, QPointF& v)
   if (polygon.size() <= 3)
     return;
 
+  // Construct the list of segments.
+  QVector<QLineF> segments(polygon.size());
+  QVector<QRectF> segmentBounds(polygon.size());
+  for (int j=0; j<polygon.size(); j++)
+  {
+    segments[j]      = _getConstraintSegment(polygon.at(j), polygon.at( (j+1) % polygon.size() ));
+    segmentBounds[j] = _segmentBounds(segments[j]);
+  }
+
+  _constrainVertex(polygon, segments, segmentBounds, i, v);
+}
+
+void Polygon::_constrainVertex(const QPolygonF& polygon,
+                               const QVector<QLineF>& segments, const QVector<QRectF>& segmentBounds,
+                               int i, QPointF& v)
+{
+  // Nothing to do (eg. triangles).
+  if (polygon.size() <= 3)
+    return;
+
+  Q_ASSERT(segments.size() == polygon.size() && segmentBounds.size() == polygon.size());
+
   // Save original vertex.
   QPointF originalV = polygon.at(i);
 
   // Line between original and new point (for later use during intersection check).
   QLineF  originalToNew(originalV, v);
+  QRectF  originalToNewBounds = _segmentBounds(originalToNew);
 
   // Look at the two adjunct segments to vertex i and see if they
   // intersect with any non-adjacent segments.
-
-  // Construct the list of segments (with the new candidate vertex).
-  QVector<QLineF> segments = _getSegments(polygon);
   int prev = wrapAround(i - 1, segments.size());
   int next = wrapAround(i + 1, segments.size());
-  segments[prev] = QLineF(polygon.at(prev), v);
-  segments[i]    = QLineF(v, polygon.at(next));
 
-  // We now stretch segments a little bit to cope with approximation errors.
-  for (QVector<QLineF>::Iterator it = segments.begin(); it != segments.end(); ++it)
-  {
-    QLineF&   seg = *it;
-    QPointF p1 = seg.p1();
-    QPointF p2 = seg.p2();
-    // Create small vector pointing in same direction as segment.
-    QVector2D vec(p2 - p1);
-    vec *= _CONSTRAIN_VERTEX_SEGMENT_ELONGATION / vec.length();
-    QPointF diff = vec.toPointF();
-    // Use it to elongate segment slightly.
-    seg.setP1( p1 - diff);
-    seg.setP2( p2 + diff);
-  }
+  // The two adjunct segments (with the new candidate vertex), stretched a little
+  // bit to cope with approximation errors. Other segments are left untouched.
+  QLineF adjunct[2];
+  adjunct[0] = _getConstraintSegment(polygon.at(prev), v);
+  adjunct[1] = _getConstraintSegment(v, polygon.at(next));
 
   // For each adjunct segment.
   for (int adj=0; adj<2; adj++)
   {
     int idx = wrapAround(i + adj - 1, segments.size());
+
+    // Area where intersections can happen.
+    QRectF searchBounds = _searchBounds(adjunct[adj], originalToNewBounds, _CONSTRAIN_VERTEX_BOUNDS_MARGIN);
     for (int j=0; j<segments.size(); j++)
     {
       // If the segment to compare to is valid (ie. if it is not
@@ -80,8 +176,12 @@ void Polygon::_constrainVertex(const QPolygonF& polygon, int i, QPointF& v)
           j != wrapAround(idx-1, segments.size()) &&
           j != wrapAround(idx+1, segments.size()))
       {
+        // Skip segments that are too far to intersect.
+        if (!_boundsOverlap(searchBounds, segmentBounds[j]))
+          continue;
+
         QPointF intersection;
-        if (segments[idx].intersect(segments[j], &intersection) == QLineF::BoundedIntersection ||
+        if (adjunct[adj].intersect(segments[j], &intersection) == QLineF::BoundedIntersection ||
             originalToNew.intersect(segments[j], &intersection) == QLineF::BoundedIntersection)
         {
           // Rearrange segments with new position at intersection point.
@@ -90,8 +190,9 @@ void Polygon::_constrainVertex(const QPolygonF& polygon, int i, QPointF& v)
           vec *= _CONSTRAIN_VERTEX_INTERSECTION_PULLAWAY / vec.length();
           QPointF diff = vec.toPointF();
           v = intersection - diff;
-          segments[prev] = QLineF(polygon.at(prev), v);
-          segments[i]    = QLineF(v, polygon.at(next));
+          adjunct[0] = QLineF(polygon.at(prev), v);
+          adjunct[1] = QLineF(v, polygon.at(next));
+          searchBounds = _searchBounds(adjunct[adj], originalToNewBounds, _CONSTRAIN_VERTEX_BOUNDS_MARGIN);
         }
       }
     }
@@ -100,6 +201,7 @@ void Polygon::_constrainVertex(const QPolygonF& polygon, int i, QPointF& v)
 
 qreal Polygon::_CONSTRAIN_VERTEX_SEGMENT_ELONGATION    = 10.0;
 qreal Polygon::_CONSTRAIN_VERTEX_INTERSECTION_PULLAWAY = 30.0;
+qreal Polygon::_CONSTRAIN_VERTEX_BOUNDS_MARGIN         = 1.0;
 
 QVector<QLineF> Polygon::_getSegments() const
 {
@@ -132,6 +234,7 @@ void Polygon::fromPolygon(const QPolygonF& p)
 	Q_ASSERT(p.size() == nVertices());
 	for (int i=0; i<nVertices(); i++)
 		vertices[i] = p[i];
+	_bumpVersion();
 	build();
 }
 
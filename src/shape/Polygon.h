@@ -30,8 +30,8 @@ class Polygon : public MShape
 {
   Q_OBJECT
 public:
-  Polygon() {}
-  Polygon(QVector<QPointF> vertices_) : MShape(vertices_) {}
+  Polygon() : _constraintSegmentsVersion(0) {}
+  Polygon(QVector<QPointF> vertices_) : MShape(vertices_), _constraintSegmentsVersion(0) {}
   virtual ~Polygon() {}
 
   virtual QPolygonF toPolygon() const;
@@ -54,9 +54,34 @@ protected:
   /// Makes sure vertex v as the i-th point of polygon stays inside the polygon.
   static void _constrainVertex(const QPolygonF& polygon, int i, QPointF& v);
 
+  /**
+   * Same as above, using precomputed constraint segments of polygon (see _getConstraintSegment())
+   * and their bounding boxes. Segments whose bounding box is away from the moved vertex are
+   * skipped without testing for intersection.
+   */
+  static void _constrainVertex(const QPolygonF& polygon,
+                               const QVector<QLineF>& segments, const QVector<QRectF>& segmentBounds,
+                               int i, QPointF& v);
+
+  /// Returns segment (p1, p2) slightly elongated on both ends, as used to constrain vertices.
+  static QLineF _getConstraintSegment(const QPointF& p1, const QPointF& p2);
+
   // Parameters used to constrain vertex.
   static qreal _CONSTRAIN_VERTEX_SEGMENT_ELONGATION;
   static qreal _CONSTRAIN_VERTEX_INTERSECTION_PULLAWAY;
+  static qreal _CONSTRAIN_VERTEX_BOUNDS_MARGIN;
+
+private:
+  // Recomputes constraint segments if vertices were changed since last time.
+  void _updateConstraintSegments(const QPolygonF& polygon);
+
+  // Recomputes constraint segment i and its bounding box.
+  void _updateConstraintSegment(const QPolygonF& polygon, int i);
+
+  // Constraint segments cache (kept up to date incrementally while dragging a vertex).
+  QVector<QLineF> _constraintSegments;
+  QVector<QRectF> _constraintSegmentBounds;
+  quint64 _constraintSegmentsVersion;
 };
 
 }
@@ -21,11 +21,32 @@
 
 namespace mmp {
 
-MShape::MShape(const QVector<QPointF>& vertices_) : _isLocked(false) {
+/// Translates n vertices by offset.
+static void translateVertices(QPointF* vertices, int n, const QPointF& offset)
+{
+  for (int i=0; i<n; i++)
+    vertices[i] += offset;
+}
+
+/// Applies affine transform to n vertices (same results as QTransform::map()).
+static void affineTransformVertices(QPointF* vertices, int n, const QTransform& t)
+{
+  for (int i=0; i<n; i++)
+  {
+    qreal x = vertices[i].x();
+    qreal y = vertices[i].y();
+    vertices[i].setX(t.m11()*x + t.m21()*y + t.dx());
+    vertices[i].setY(t.m12()*x + t.m22()*y + t.dy());
+  }
+}
+
+MShape::MShape(const QVector<QPointF>& vertices_) : _isLocked(false), _version(0) {
   setVertices(vertices_);
   build();
 }
 
+quint64 MShape::_lastVersion = 0;
+
 void MShape::copyFrom(const MShape& shape)
 {
   // Just copy vertices.
@@ -49,9 +70,28 @@ void MShape::setShapeMode(MShape::ShapeMode mode, bool next)
 
 void MShape::applyTransform(const QTransform& transform)
 {
-  for (QVector<QPointF>::iterator it = vertices.begin();
-       it != vertices.end(); ++it)
-    (*it) = transform.map(*it);
+  // Use the fastest kernel for the type of transform.
+  switch (transform.type())
+  {
+  case QTransform::TxNone:
+    return;
+
+  case QTransform::TxTranslate:
+    translateVertices(vertices.data(), vertices.size(), QPointF(transform.dx(), transform.dy()));
+    break;
+
+  case QTransform::TxScale:
+  case QTransform::TxRotate:
+  case QTransform::TxShear:
+    affineTransformVertices(vertices.data(), vertices.size(), transform);
+    break;
+
+  default:
+    for (QVector<QPointF>::iterator it = vertices.begin();
+         it != vertices.end(); ++it)
+      (*it) = transform.map(*it);
+  }
+  _bumpVersion();
 }
 
 void MShape::transform(const QPointF& translate, qreal scale, qreal rotate)
@@ -79,7 +119,12 @@ void MShape::transform(const QPointF& translate, qreal scale, qreal rotate)
 
 void MShape::translate(const QPointF& offset)
 {
-	transform(offset, 0, 0);
+	// No need to go through a full transform.
+	if (!offset.isNull())
+	{
+		translateVertices(vertices.data(), vertices.size(), offset);
+		_bumpVersion();
+	}
 }
 
 void MShape::rotate(qreal angle)
@@ -101,6 +146,11 @@ QPointF MShape::getCenter() const
   return center;
 }
 
+QRectF MShape::getBoundingRect() const
+{
+  return QPolygonF(vertices).boundingRect();
+}
+
 void MShape::read(const QDomElement& obj)
 {
   // Read basic data.
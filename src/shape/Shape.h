@@ -63,7 +63,7 @@ public:
 
   typedef QSharedPointer<MShape> ptr;
 
-  MShape() : _isLocked(false) {}
+  MShape() : _isLocked(false), _version(0) {}
   MShape(const QVector<QPointF>& vertices_);
   virtual ~MShape() {}
 
@@ -130,14 +130,28 @@ public:
     // Deep copy.
     vertices.resize(vertices_.size());
     qCopy(vertices_.begin(), vertices_.end(), vertices.begin());
+    _bumpVersion();
   }
 
+  /**
+   * Returns the geometry version of the shape: it changes every time vertices (or
+   * their layout) change, and is unique across shapes. Caches derived from the
+   * geometry can thus check their validity with a single comparison.
+   */
+  quint64 getVersion() const { return _version; }
+
+  /// Returns the last version given to any shape (changes whenever any shape is modified).
+  static quint64 getLastVersion() { return _lastVersion; }
+
   // Returns true iff vertex index is considered a major (external) control point.
   virtual bool isMajorVertex(int idx) const { Q_UNUSED(idx); return true; }
 
 	// Returns center of object.
 	virtual QPointF getCenter() const;
 
+  /// Returns a rectangle (in shape coordinates) that contains the whole shape.
+  virtual QRectF getBoundingRect() const;
+
   virtual void read(const QDomElement& obj);
   virtual void write(QDomElement& obj);
 
@@ -148,13 +162,18 @@ protected:
   void _addVertex(const QPointF& vertex)
   {
     vertices.push_back(vertex);
+    _bumpVersion();
   }
 
   void _rawSetVertex(int i, const QPointF& v)
   {
     vertices[i] = v;
+    _bumpVersion();
   }
 
+  /// Must be called whenever vertices are modified directly.
+  void _bumpVersion() { _version = ++_lastVersion; }
+
   /// Returns a new MShape (using default constructor).
   virtual MShape* _create() const = 0;
 
@@ -163,6 +182,11 @@ protected:
 
 private:
   MShape::ShapeMode _shapeMode = MShape::DefaultMode;
+
+  quint64 _version;
+
+  // Last version given to any shape (shapes are only modified from the GUI thread).
+  static quint64 _lastVersion;
 };
 
 
@@ -2,6 +2,7 @@
 include(../src.pri)
 
 HEADERS += $$PWD/Ellipse.h \
+    $$PWD/Geometry.h \
     $$PWD/Mesh.h \
     $$PWD/Polygon.h \
     $$PWD/Quad.h \
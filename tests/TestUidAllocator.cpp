@@ -0,0 +1,107 @@
+#include "TestUidAllocator.h"
+
+#include "core/UidAllocator.h"
+
+using namespace mmp;
+
+// Number of ids used by benchmarks (eg. a generated show with many mappings).
+static const int N_BENCHMARK_IDS = 20000;
+
+void TestUidAllocator::allocate()
+{
+        UidAllocator allocator;
+        QCOMPARE(allocator.allocate(), 1);
+        QCOMPARE(allocator.allocate(), 2);
+        QCOMPARE(allocator.allocate(), 3);
+        QCOMPARE(allocator.size(), 3);
+
+        // Released ids are reused.
+        QVERIFY(allocator.free(2));
+        QVERIFY(!allocator.exists(2));
+        QCOMPARE(allocator.allocate(), 2);
+        QCOMPARE(allocator.allocate(), 4);
+}
+
+void TestUidAllocator::reserve()
+{
+        UidAllocator allocator;
+        QVERIFY(allocator.reserve(2));
+        QVERIFY(!allocator.reserve(2));
+        QVERIFY(!allocator.reserve(NULL_UID));
+
+        // Reserved ids are skipped.
+        QCOMPARE(allocator.allocate(), 1);
+        QCOMPARE(allocator.allocate(), 3);
+
+        // Released id reserved again is not given away.
+        QVERIFY(allocator.free(1));
+        QVERIFY(allocator.reserve(1));
+        QCOMPARE(allocator.allocate(), 4);
+
+        std::vector<uid> ids = allocator.list();
+        QCOMPARE(int(ids.size()), 4);
+        QCOMPARE(ids.front(), 1);
+        QCOMPARE(ids.back(), 4);
+}
+
+void TestUidAllocator::doubleFree()
+{
+        UidAllocator allocator;
+        uid id = allocator.allocate();
+        QVERIFY(allocator.free(id));
+        QVERIFY(!allocator.free(id));
+        QVERIFY(!allocator.free(id + 100));
+        QCOMPARE(allocator.size(), 0);
+
+        // Id must only be handed out once.
+        QCOMPARE(allocator.allocate(), id);
+        QVERIFY(allocator.allocate() != id);
+}
+
+void TestUidAllocator::largeIds()
+{
+        // Ids read from files can be arbitrarily large.
+        UidAllocator allocator;
+        QVERIFY(allocator.reserve(2000000000));
+        QVERIFY(!allocator.reserve(2000000000));
+        QVERIFY(allocator.exists(2000000000));
+        QVERIFY(allocator.reserve(1500000000));
+        QCOMPARE(allocator.allocate(), 1);
+        QCOMPARE(allocator.size(), 3);
+
+        std::vector<uid> ids = allocator.list();
+        QCOMPARE(int(ids.size()), 3);
+        QCOMPARE(ids[0], 1);
+        QCOMPARE(ids[1], 1500000000);
+        QCOMPARE(ids[2], 2000000000);
+
+        QVERIFY(allocator.free(2000000000));
+        QVERIFY(!allocator.exists(2000000000));
+        QVERIFY(!allocator.free(2000000000));
+        QCOMPARE(allocator.size(), 2);
+}
+
+void TestUidAllocator::benchmarkAllocate()
+{
+        QBENCHMARK {
+                UidAllocator allocator;
+                for (int i=0; i<N_BENCHMARK_IDS; i++)
+                        allocator.allocate();
+        }
+}
+
+void TestUidAllocator::benchmarkAllocateFree()
+{
+        UidAllocator allocator;
+        for (int i=0; i<N_BENCHMARK_IDS; i++)
+                allocator.allocate();
+
+        QBENCHMARK {
+                for (uid id=1; id<=N_BENCHMARK_IDS; id+=2)
+                        allocator.free(id);
+                for (uid id=1; id<=N_BENCHMARK_IDS; id+=2)
+                        allocator.allocate();
+        }
+}
+
+QTEST_MAIN(TestUidAllocator)
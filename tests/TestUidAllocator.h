@@ -0,0 +1,14 @@
+#include <QtTest/QtTest>
+
+class TestUidAllocator: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void allocate();
+        void reserve();
+        void doubleFree();
+        void largeIds();
+        void benchmarkAllocate();
+        void benchmarkAllocateFree();
+};
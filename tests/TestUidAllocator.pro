@@ -0,0 +1,17 @@
+QT += testlib
+QT += core gui
+
+CONFIG += c++11
+
+TARGET = TestUidAllocator
+
+CONFIG += console
+CONFIG += app_bundle
+
+SOURCES = TestUidAllocator.cpp \
+          ../src/core/UidAllocator.cpp
+
+HEADERS = TestUidAllocator.h
+
+INCLUDEPATH += $$PWD/../src/ \
+               $$PWD/../src/core/